@@ -0,0 +1,465 @@
+/* Exact cover solver using Knuth's Algorithm X with Dancing Links.
+ * See dlx.h for the interface.
+ *
+ * The matrix is kept in arrays of integers instead of linked structs,
+ * so a copy for another thread is a handful of memcpy. Node 0 is the
+ * root, nodes 1 to nitems are the headers of the items and the rest
+ * are the nodes of the options. Only the primary items are linked to
+ * the root, so the search never chooses a secondary item, but they
+ * are covered as any other item when an option that has them is
+ * chosen.
+ *
+ *
+ * File: dlx.c
+ * Date: 18.10.2026
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "dlx.h"
+
+#define DLX_MIN_NODES 64		/* first allocation of nodes	*/
+
+
+static int grow (int **, int, size_t);
+static void cover (struct dlx *, int);
+static void uncover (struct dlx *, int);
+static void search (struct dlx *, int, int, dlx_visit_fn, void *,
+		    atomic_int *);
+
+
+/* dlx_create allocates an empty matrix with its item headers
+ *
+ * Input:		nprimary	number of primary items
+ *			nsecondary	number of secondary items
+ * Return value:	new matrix, or NULL if there's no memory
+ *
+ */
+struct dlx *dlx_create (int nprimary, int nsecondary)
+{
+  struct dlx *d;
+  int i, n;
+
+  d = (struct dlx *) calloc (1, sizeof (struct dlx));
+  if (d == NULL)
+  {
+    return NULL;
+  }
+  d->nprimary = nprimary;
+  d->nitems = nprimary + nsecondary;
+  d->nnodes = d->nitems + 1;
+  d->maxnodes = (d->nnodes > DLX_MIN_NODES) ? d->nnodes : DLX_MIN_NODES;
+
+  n = d->maxnodes;
+  d->left   = (int *) malloc (n * sizeof (int));
+  d->right  = (int *) malloc (n * sizeof (int));
+  d->up     = (int *) malloc (n * sizeof (int));
+  d->down   = (int *) malloc (n * sizeof (int));
+  d->top    = (int *) malloc (n * sizeof (int));
+  d->option = (int *) malloc (n * sizeof (int));
+  d->len    = (int *) calloc (d->nitems + 1, sizeof (int));
+  d->sol    = (int *) malloc ((nprimary + 1) * sizeof (int));
+  d->solopt = (int *) malloc ((nprimary + 1) * sizeof (int));
+  if ((d->left == NULL) || (d->right == NULL) || (d->up == NULL) ||
+      (d->down == NULL) || (d->top == NULL) || (d->option == NULL) ||
+      (d->len == NULL) || (d->sol == NULL) || (d->solopt == NULL))
+  {
+    dlx_destroy (d);
+    return NULL;
+  }
+
+  /* Primary items in a circular list with the root, secondary items
+   * linked to themselves						*/
+  for (i = 0; i <= d->nitems; i++)
+  {
+    if ((i == 0) || (i > nprimary))
+    {
+      d->left[i] = d->right[i] = i;
+    }
+    else
+    {
+      d->left[i] = i - 1;
+      d->right[i] = (i == nprimary) ? 0 : i + 1;
+    }
+    d->up[i] = d->down[i] = d->top[i] = i;
+    d->option[i] = -1;
+  }
+  if (nprimary > 0)
+  {
+    d->right[0] = 1;
+    d->left[0] = nprimary;
+  }
+
+  return d;
+}
+
+
+/* dlx_add_option adds an option to the matrix. The items are numbered
+ * from 0, first the primary ones and then the secondary ones, and
+ * every item can appear only once in the option.
+ *
+ * Input:		d		matrix
+ *			items		items of the option
+ *			nitems		number of items
+ * Return value:	id of the option (from 0), or -1 if the items are
+ *			wrong or there's no memory
+ *
+ */
+int dlx_add_option (struct dlx *d, const int *items, int nitems)
+{
+  int i, h, x, first, primary;
+
+  for (i = primary = 0; i < nitems; i++)
+  {
+    if ((items[i] < 0) || (items[i] >= d->nitems))
+    {
+      return -1;
+    }
+    primary += (items[i] < d->nprimary);
+  }
+  if (primary == 0)			/* it could never be chosen	*/
+  {
+    return -1;
+  }
+
+  /* Make room for the new nodes and the new option			*/
+  if (d->nnodes + nitems > d->maxnodes)
+  {
+    int n = d->maxnodes;
+
+    while (d->nnodes + nitems > n)
+    {
+      n *= 2;
+    }
+    if (grow (&d->left, n, sizeof (int)) || grow (&d->right, n, sizeof (int)) ||
+	grow (&d->up, n, sizeof (int)) || grow (&d->down, n, sizeof (int)) ||
+	grow (&d->top, n, sizeof (int)) || grow (&d->option, n, sizeof (int)))
+    {
+      return -1;
+    }
+    d->maxnodes = n;
+  }
+  if (d->noptions == d->maxoptions)
+  {
+    int n = (d->maxoptions > 0) ? 2 * d->maxoptions : DLX_MIN_NODES;
+
+    if (grow (&d->first, n, sizeof (int)))
+    {
+      return -1;
+    }
+    d->maxoptions = n;
+  }
+
+  /* Every node goes to the bottom of its item and to the end of the
+   * circular list of the option					*/
+  first = d->nnodes;
+  for (i = 0; i < nitems; i++)
+  {
+    h = items[i] + 1;
+    x = d->nnodes++;
+    d->top[x] = h;
+    d->option[x] = d->noptions;
+    d->up[x] = d->up[h];
+    d->down[x] = h;
+    d->down[d->up[h]] = x;
+    d->up[h] = x;
+    d->len[h]++;
+    d->left[x] = (i == 0) ? x : x - 1;
+    d->right[x] = first;
+    d->right[d->left[x]] = x;
+    d->left[first] = x;
+  }
+  d->first[d->noptions] = first;
+
+  return d->noptions++;
+}
+
+
+/* dlx_copy makes an independent copy of a matrix, including the
+ * options chosen so far.
+ *
+ * Input:		d		matrix to copy
+ * Return value:	new matrix, or NULL if there's no memory
+ *
+ */
+struct dlx *dlx_copy (const struct dlx *d)
+{
+  struct dlx *c;
+  size_t nodes, items, options, levels;
+
+  c = (struct dlx *) malloc (sizeof (struct dlx));
+  if (c == NULL)
+  {
+    return NULL;
+  }
+  *c = *d;
+
+  nodes = d->maxnodes * sizeof (int);
+  items = (d->nitems + 1) * sizeof (int);
+  options = d->maxoptions * sizeof (int);
+  levels = (d->nprimary + 1) * sizeof (int);
+  c->left   = (int *) malloc (nodes);
+  c->right  = (int *) malloc (nodes);
+  c->up     = (int *) malloc (nodes);
+  c->down   = (int *) malloc (nodes);
+  c->top    = (int *) malloc (nodes);
+  c->option = (int *) malloc (nodes);
+  c->len    = (int *) malloc (items);
+  c->first  = (options > 0) ? (int *) malloc (options) : NULL;
+  c->sol    = (int *) malloc (levels);
+  c->solopt = (int *) malloc (levels);
+  if ((c->left == NULL) || (c->right == NULL) || (c->up == NULL) ||
+      (c->down == NULL) || (c->top == NULL) || (c->option == NULL) ||
+      (c->len == NULL) || ((options > 0) && (c->first == NULL)) ||
+      (c->sol == NULL) || (c->solopt == NULL))
+  {
+    dlx_destroy (c);
+    return NULL;
+  }
+
+  memcpy (c->left, d->left, nodes);
+  memcpy (c->right, d->right, nodes);
+  memcpy (c->up, d->up, nodes);
+  memcpy (c->down, d->down, nodes);
+  memcpy (c->top, d->top, nodes);
+  memcpy (c->option, d->option, nodes);
+  memcpy (c->len, d->len, items);
+  if (options > 0)
+  {
+    memcpy (c->first, d->first, options);
+  }
+  memcpy (c->sol, d->sol, levels);
+  memcpy (c->solopt, d->solopt, levels);
+
+  return c;
+}
+
+
+/* dlx_choose chooses an option before searching, covering all its
+ * items as the search would do. None of its items can be covered
+ * already. It's used to search a subtree of the whole search.
+ *
+ * Input:		d		matrix
+ *			opt		id of the option
+ * Return value:	none
+ *
+ */
+void dlx_choose (struct dlx *d, int opt)
+{
+  int r, j;
+
+  r = d->first[opt];
+  cover (d, d->top[r]);
+  for (j = d->right[r]; j != r; j = d->right[j])
+  {
+    cover (d, d->top[j]);
+  }
+  d->solopt[d->level] = opt;
+  d->sol[d->level++] = r;
+}
+
+
+/* dlx_unchoose undoes the last dlx_choose, uncovering the items in
+ * the reverse order.
+ *
+ * Input:		d		matrix
+ * Return value:	none
+ *
+ */
+void dlx_unchoose (struct dlx *d)
+{
+  int r, j;
+
+  r = d->sol[--d->level];
+  for (j = d->left[r]; j != r; j = d->left[j])
+  {
+    uncover (d, d->top[j]);
+  }
+  uncover (d, d->top[r]);
+}
+
+
+/* dlx_search finds all the exact covers of the items left, calling
+ * visit for each one. With a maximum depth, it stops choosing options
+ * at that depth and calls visit with the partial solution instead.
+ *
+ * Input:		d		matrix
+ *			maxdepth	options to choose, or < 0 for all
+ *			visit		called per (partial) solution
+ *			arg		passed to visit
+ *			stop		if not NULL, stop when set
+ * Return value:	none
+ *
+ */
+void dlx_search (struct dlx *d, int maxdepth, dlx_visit_fn visit, void *arg,
+		 atomic_int *stop)
+{
+  search (d, 0, maxdepth, visit, arg, stop);
+}
+
+
+/* dlx_destroy deallocates a matrix
+ *
+ * Input:		d		matrix
+ * Return value:	none
+ *
+ */
+void dlx_destroy (struct dlx *d)
+{
+  if (d == NULL)
+  {
+    return;
+  }
+  free (d->left);
+  free (d->right);
+  free (d->up);
+  free (d->down);
+  free (d->top);
+  free (d->option);
+  free (d->len);
+  free (d->first);
+  free (d->sol);
+  free (d->solopt);
+  free (d);
+}
+
+
+/* grow reallocates an array to a new number of elements
+ *
+ * Input:		array		pointer to the array
+ *			n		new number of elements
+ *			size		size of one element
+ * Return value:	0 on success, 1 if there's no memory
+ *
+ */
+static int grow (int **array, int n, size_t size)
+{
+  int *p;
+
+  p = (int *) realloc (*array, n * size);
+  if (p == NULL)
+  {
+    return 1;
+  }
+  *array = p;
+  return 0;
+}
+
+
+/* cover removes an item from the list of items and all the options
+ * that have it from the other items.
+ *
+ * Input:		d		matrix
+ *			c		header node of the item
+ * Return value:	none
+ *
+ */
+static void cover (struct dlx *d, int c)
+{
+  int i, j;
+
+  d->left[d->right[c]] = d->left[c];
+  d->right[d->left[c]] = d->right[c];
+  for (i = d->down[c]; i != c; i = d->down[i])
+  {
+    for (j = d->right[i]; j != i; j = d->right[j])
+    {
+      d->up[d->down[j]] = d->up[j];
+      d->down[d->up[j]] = d->down[j];
+      d->len[d->top[j]]--;
+    }
+  }
+}
+
+
+/* uncover puts back what cover removed, in the reverse order, so the
+ * links dance back to their places.
+ *
+ * Input:		d		matrix
+ *			c		header node of the item
+ * Return value:	none
+ *
+ */
+static void uncover (struct dlx *d, int c)
+{
+  int i, j;
+
+  for (i = d->up[c]; i != c; i = d->up[i])
+  {
+    for (j = d->left[i]; j != i; j = d->left[j])
+    {
+      d->len[d->top[j]]++;
+      d->up[d->down[j]] = j;
+      d->down[d->up[j]] = j;
+    }
+  }
+  d->left[d->right[c]] = c;
+  d->right[d->left[c]] = c;
+}
+
+
+/* search is Algorithm X: choose the primary item with less options
+ * left, and try every one of its options recursively.
+ *
+ * Input:		d		matrix
+ *			depth		options chosen by this search
+ *			maxdepth	options to choose, or < 0 for all
+ *			visit, arg	called per (partial) solution
+ *			stop		if not NULL, stop when set
+ * Return value:	none
+ *
+ */
+static void search (struct dlx *d, int depth, int maxdepth,
+		    dlx_visit_fn visit, void *arg, atomic_int *stop)
+{
+  int c, i, r, j;
+
+  if (d->right[0] == 0)			/* all primary items covered	*/
+  {
+    visit (d->solopt, d->level, 1, arg);
+    return;
+  }
+  if (depth == maxdepth)		/* subtree for somebody else	*/
+  {
+    visit (d->solopt, d->level, 0, arg);
+    return;
+  }
+
+  /* Minimum remaining values heuristic					*/
+  c = d->right[0];
+  for (i = d->right[c]; i != 0; i = d->right[i])
+  {
+    if (d->len[i] < d->len[c])
+    {
+      c = i;
+    }
+  }
+  if (d->len[c] == 0)			/* dead end			*/
+  {
+    return;
+  }
+
+  cover (d, c);
+  for (r = d->down[c]; r != c; r = d->down[r])
+  {
+    if ((stop != NULL) && atomic_load_explicit (stop, memory_order_relaxed))
+    {
+      break;
+    }
+    d->solopt[d->level] = d->option[r];
+    d->sol[d->level++] = r;
+    for (j = d->right[r]; j != r; j = d->right[j])
+    {
+      cover (d, d->top[j]);
+    }
+    search (d, depth + 1, maxdepth, visit, arg, stop);
+    for (j = d->left[r]; j != r; j = d->left[j])
+    {
+      uncover (d, d->top[j]);
+    }
+    d->level--;
+  }
+  uncover (d, c);
+}
@@ -0,0 +1,55 @@
+/* Exact cover solver using Knuth's Algorithm X with Dancing Links.
+ * It's used by the DLX engine of the nqueens library, but it doesn't
+ * know anything about queens: a matrix has primary items, that must
+ * be covered exactly once, and secondary items, that can be covered
+ * at most once, and a list of options made of items.
+ *
+ * A matrix can't be shared by several threads while searching, since
+ * the search unlinks and relinks its nodes (the dancing links). Every
+ * thread works on its own copy made with dlx_copy.
+ *
+ *
+ * File: dlx.h
+ * Date: 18.10.2026
+ */
+
+
+#ifndef DLX_H
+#define DLX_H
+
+#include <stdatomic.h>
+
+struct dlx
+{
+  int nprimary,				/* number of primary items	*/
+      nitems,				/* primary + secondary items	*/
+      nnodes, maxnodes,			/* used and allocated nodes	*/
+      noptions, maxoptions,		/* used and allocated options	*/
+      *left, *right,			/* horizontal links		*/
+      *up, *down,			/* vertical links		*/
+      *top,				/* item of every node		*/
+      *option,				/* option of every node		*/
+      *len,				/* nodes left in every item	*/
+      *first,				/* first node of every option	*/
+      *sol,				/* chosen nodes by level	*/
+      *solopt,				/* chosen options by level	*/
+      level;				/* number of chosen nodes	*/
+};
+
+/* Called by dlx_search for every complete solution (complete = 1) and
+ * for every partial solution that reaches the maximum depth of the
+ * search (complete = 0). options has the ids of the chosen options,
+ * including the ones chosen with dlx_choose before the search.		*/
+typedef void (*dlx_visit_fn) (const int *options, int noptions,
+			      int complete, void *arg);
+
+
+struct dlx *dlx_create (int, int);
+int dlx_add_option (struct dlx *, const int *, int);
+struct dlx *dlx_copy (const struct dlx *);
+void dlx_choose (struct dlx *, int);
+void dlx_unchoose (struct dlx *);
+void dlx_search (struct dlx *, int, dlx_visit_fn, void *, atomic_int *);
+void dlx_destroy (struct dlx *);
+
+#endif
@@ -6,11 +6,30 @@
  * threads to be created can be passed as a command-line parameter when 
  * executing the program. 
  * 
+ * With the option -b it becomes a barrier benchmark instead: the 
+ * threads run a number of phases of busy work, separated by a barrier. 
+ * It compares a pthread_barrier_t, a mutex and condition variable 
+ * barrier, a sense-reversing spin barrier and (on Linux) a futex based 
+ * barrier, first pinned with one thread per CPU (skipped when there 
+ * are more threads than CPUs) and then oversubscribed, with the 
+ * threads pinned round-robin on half as many CPUs, or on all of them 
+ * if there are fewer, so at least two threads per CPU when there are 
+ * two or more threads. For every barrier it 
+ * shows the threads per CPU, the percentiles of the barrier latency 
+ * per phase (time from the last thread arriving to the last thread 
+ * leaving) and the total throughput in phases per second.
+ * 
+ * Optionally, when compiled with -DTRACE and trace.c, it writes a 
+ * timeline of the threads (start, work, barrier waits, exit) to 
+ * trace.json, see trace.h.
+ * 
  * Compilation
  *	gcc -Wall -lpthread -o holamigos holamigos.c
+ *	gcc -DTRACE -Wall -lpthread -o holamigos holamigos.c trace.c
  * 
  * Execution 
  *	./holamigos [number_of_threads]
+ *	./holamigos -b [number_of_threads] [number_of_phases] [work_per_phase]
  * 
  *
  * File: holamigos.c			Author: Manases Galindo
@@ -19,17 +38,109 @@
 
 
 
+#define _GNU_SOURCE			/* CPU affinity of threads	*/
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <limits.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+#include "trace.h"
 
 #define NUM_THREADS 4			/* default number of threads	*/
+#define NUM_PHASES  1000		/* default number of phases	*/
+#define NUM_WORK    10000		/* default work per phase	*/
+#define SPIN_LIMIT  1024		/* spins before yielding	*/
+#define CACHE_LINE  64			/* to avoid false sharing	*/
+#define NUM_BARRIERS ((int) (sizeof (barrier_types) / sizeof (barrier_types[0])))
+
+#if defined(_POSIX_BARRIERS) && (_POSIX_BARRIERS > 0)
+#define HAVE_PTHREAD_BARRIER
+#endif
+
+/* Barrier built with a mutex and a condition variable		*/
+struct cond_barrier
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int count,				/* threads still to arrive	*/
+      nthreads;				/* threads to wait for		*/
+  unsigned int phase;			/* changes on every release	*/
+};
+
+/* Sense-reversing spin barrier. The counter and the sense are kept in
+ * different cache lines, the arriving threads write the first one and
+ * the waiting threads spin reading the second one.			*/
+struct spin_barrier
+{
+  atomic_int count;			/* threads still to arrive	*/
+  char pad[CACHE_LINE];
+  atomic_int sense;			/* flips on every release	*/
+  int nthreads;				/* threads to wait for		*/
+};
+
+/* Futex based barrier, the waiting threads sleep in the kernel until
+ * the phase word changes.						*/
+struct futex_barrier
+{
+  atomic_int count;			/* threads still to arrive	*/
+  char pad[CACHE_LINE];
+  atomic_int phase;			/* futex word			*/
+  int nthreads;				/* threads to wait for		*/
+};
+
+union barrier				/* one barrier of any type	*/
+{
+#ifdef HAVE_PTHREAD_BARRIER
+  pthread_barrier_t pth;
+#endif
+  struct cond_barrier cond;
+  struct spin_barrier spin;
+  struct futex_barrier futex;
+};
+
+struct barrier_type			/* how to use a barrier type	*/
+{
+  const char *name;
+  void (*init) (int);			/* number of threads		*/
+  void (*wait) (int *);			/* local sense of the thread	*/
+  void (*destroy) (void);
+};
 
 /* Shared global variables. All threads can access them.	  	*/
-int nthreads;				/* number of threads		*/
+int nthreads,				/* number of threads		*/
+    nphases,				/* number of phases		*/
+    nwork,				/* work iterations per phase	*/
+    ncpus,				/* CPUs used by the threads	*/
+    pinned;				/* one thread per CPU?		*/
+#ifdef __linux__
+int cpu_ids[CPU_SETSIZE];		/* CPUs the process may use	*/
+#endif
+atomic_int affinity_err;		/* first failure to pin		*/
+pthread_mutex_t start_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t start_cond = PTHREAD_COND_INITIALIZER;
+int start_state;			/* 0 wait, 1 go, -1 abort run	*/
+union barrier bar;			/* barrier being measured	*/
+const struct barrier_type *bar_type;	/* and its type			*/
+struct timespec *arrive, *depart,	/* per thread and phase		*/
+		*started;		/* per thread			*/
 
 
 void *say_hello (void *);
+int barrier_bench (int, char **);	/* run the barrier benchmark	*/
+void run_barrier (const struct barrier_type *, int, int);
+void *run_phases (void *);
+int cmp_double (const void *, const void *);
+int available_cpus (void);		/* CPUs the process may use	*/
+int set_affinity (int);
 
 
 int main (int argc, char **argv)
@@ -38,6 +149,12 @@ int main (int argc, char **argv)
       *thr_num;				/* array of thread numbers	*/
   pthread_t *thr_ids;			/* array of thread ids		*/
 
+  /* Barrier benchmark instead of greetings				*/
+  if ((argc > 1) && (strcmp (argv[1], "-b") == 0))
+  {
+    return barrier_bench (argc, argv);
+  }
+
   switch (argc)				/* check command line arguments	*/
   {
     case 1:
@@ -63,8 +180,10 @@ int main (int argc, char **argv)
     default:
       fprintf (stderr, "Error: wrong number of parameters.\n"
 	       "Usage:\n"
-	       "  %s [number_of_threads]\n",
-	       argv[0]);
+	       "  %s [number_of_threads]\n"
+	       "  %s -b [number_of_threads] [number_of_phases] "
+	       "[work_per_phase]\n",
+	       argv[0], argv[0]);
       exit (EXIT_FAILURE);
   }
   
@@ -81,17 +200,22 @@ int main (int argc, char **argv)
   }
   
   printf ("\nHola amigos! I'm the main thread\n"); 
+  TRACE_THREAD_NAME ("main");
+  TRACE_BEGIN ("create threads");
   for (i = 0; i < nthreads; i++)	/* Create the threads		*/
   {
     thr_num[i] = i + 1;			/* Thread number	        */
     pthread_create (&thr_ids[i], NULL, say_hello, &thr_num[i]);
   }
+  TRACE_END ("create threads");
 
   /* Using join to syncronize the threads				*/
+  TRACE_BEGIN ("join threads");
   for (i = 0; i < nthreads; i++)		
   {
     pthread_join (thr_ids[i], NULL);
   }
+  TRACE_END ("join threads");
   
   /* Deallocate any memory or resources associated			*/
   free (thr_num);
@@ -115,6 +239,8 @@ void *say_hello (void *arg)
 
   /* Get the index number of current thread				*/
   thr_index = *( ( int* )arg );
+  TRACE_THREAD_NAME ("say_hello %d", thr_index);
+  TRACE_BEGIN ("say_hello");
   
   /* Select a random message to be displayed by the thread		*/
   srand (time(NULL));
@@ -146,5 +272,536 @@ void *say_hello (void *arg)
       break;
   }
   
+  TRACE_END ("say_hello");
   pthread_exit (EXIT_SUCCESS);		/* Terminate the thread		*/
 }
+
+
+/* Barrier operations of every type. They work on the global barrier
+ * bar, and the wait functions get the local sense of the calling
+ * thread, which is only used by the sense-reversing spin barrier.
+ */
+#ifdef HAVE_PTHREAD_BARRIER
+void pth_init (int n)
+{
+  pthread_barrier_init (&bar.pth, NULL, n);
+}
+
+void pth_wait (int *sense)
+{
+  pthread_barrier_wait (&bar.pth);
+}
+
+void pth_destroy (void)
+{
+  pthread_barrier_destroy (&bar.pth);
+}
+#endif
+
+void cond_init (int n)
+{
+  pthread_mutex_init (&bar.cond.mutex, NULL);
+  pthread_cond_init (&bar.cond.cond, NULL);
+  bar.cond.count = bar.cond.nthreads = n;
+  bar.cond.phase = 0;
+}
+
+void cond_wait (int *sense)
+{
+  unsigned int phase;
+
+  pthread_mutex_lock (&bar.cond.mutex);
+  phase = bar.cond.phase;
+  if (--bar.cond.count == 0)
+  {
+    /* Last one in, release the others				*/
+    bar.cond.count = bar.cond.nthreads;
+    bar.cond.phase++;
+    pthread_cond_broadcast (&bar.cond.cond);
+  }
+  else
+  {
+    /* Loop, in case of spurious wakeups				*/
+    while (phase == bar.cond.phase)
+    {
+      pthread_cond_wait (&bar.cond.cond, &bar.cond.mutex);
+    }
+  }
+  pthread_mutex_unlock (&bar.cond.mutex);
+}
+
+void cond_destroy (void)
+{
+  pthread_cond_destroy (&bar.cond.cond);
+  pthread_mutex_destroy (&bar.cond.mutex);
+}
+
+void spin_init (int n)
+{
+  atomic_init (&bar.spin.count, n);
+  atomic_init (&bar.spin.sense, 0);
+  bar.spin.nthreads = n;
+}
+
+void spin_wait (int *sense)
+{
+  int spins;
+
+  *sense = !*sense;
+  if (atomic_fetch_sub (&bar.spin.count, 1) == 1)
+  {
+    /* Last one in, reset the count and flip the sense		*/
+    atomic_store (&bar.spin.count, bar.spin.nthreads);
+    atomic_store (&bar.spin.sense, *sense);
+  }
+  else
+  {
+    /* Spin, but give the CPU away if the last one doesn't come	*/
+    for (spins = 0; atomic_load (&bar.spin.sense) != *sense; spins++)
+    {
+      if (spins >= SPIN_LIMIT)
+      {
+	sched_yield ();
+	spins = 0;
+      }
+    }
+  }
+}
+
+void spin_destroy (void)
+{
+}
+
+#ifdef __linux__
+void futex_init (int n)
+{
+  atomic_init (&bar.futex.count, n);
+  atomic_init (&bar.futex.phase, 0);
+  bar.futex.nthreads = n;
+}
+
+void futex_wait (int *sense)
+{
+  int phase;
+
+  /* Read the phase before arriving, the last thread can't change it
+   * until this one has arrived					*/
+  phase = atomic_load (&bar.futex.phase);
+  if (atomic_fetch_sub (&bar.futex.count, 1) == 1)
+  {
+    /* Last one in, start a new phase and wake up the others	*/
+    atomic_store (&bar.futex.count, bar.futex.nthreads);
+    atomic_fetch_add (&bar.futex.phase, 1);
+    syscall (SYS_futex, (int *) &bar.futex.phase, FUTEX_WAKE_PRIVATE,
+	     INT_MAX, NULL, NULL, 0);
+  }
+  else
+  {
+    /* Sleep only while the phase is still the same one		*/
+    while (atomic_load (&bar.futex.phase) == phase)
+    {
+      syscall (SYS_futex, (int *) &bar.futex.phase, FUTEX_WAIT_PRIVATE,
+	       phase, NULL, NULL, 0);
+    }
+  }
+}
+
+void futex_destroy (void)
+{
+}
+#endif
+
+const struct barrier_type barrier_types[] =
+{
+#ifdef HAVE_PTHREAD_BARRIER
+  { "pthread",	pth_init,   pth_wait,	pth_destroy },
+#endif
+  { "condvar",	cond_init,  cond_wait,	cond_destroy },
+  { "spin",	spin_init,  spin_wait,	spin_destroy },
+#ifdef __linux__
+  { "futex",	futex_init, futex_wait,	futex_destroy },
+#endif
+};
+
+
+/* barrier_bench parses the parameters of the barrier benchmark and
+ * runs it for every barrier type, pinned and oversubscribed.
+ *
+ * Input:		argc, argv	command line, argv[1] is -b
+ * Return value:	EXIT_SUCCESS or EXIT_FAILURE
+ *
+ */
+int barrier_bench (int argc, char **argv)
+{
+  int i,				/* loop variable		*/
+      navail,				/* number of available CPUs	*/
+      oversub;				/* CPUs when oversubscribed	*/
+
+  nthreads = NUM_THREADS;
+  nphases = NUM_PHASES;
+  nwork = NUM_WORK;
+  switch (argc)				/* check command line arguments	*/
+  {
+    case 5:
+      nwork = atoi (argv[4]);
+      /* fall through */
+    case 4:
+      nphases = atoi (argv[3]);
+      /* fall through */
+    case 3:
+      nthreads = atoi (argv[2]);
+      /* fall through */
+    case 2:
+      break;
+
+    default:
+      nthreads = 0;
+      break;
+  }
+  /* The times of every thread and phase are indexed with an int	*/
+  if ((nthreads < 1) || (nphases < 1) || (nwork < 0) ||
+      ((long long) nthreads * nphases > INT_MAX))
+  {
+    fprintf (stderr, "Error: wrong parameters for the barrier benchmark.\n"
+	     "Usage:\n"
+	     "  %s -b [number_of_threads] [number_of_phases] "
+	     "[work_per_phase]\n"
+	     "number_of_threads and number_of_phases should be > 0,\n"
+	     "and their product <= %d\n"
+	     "work_per_phase should be >= 0\n",
+	     argv[0], INT_MAX);
+    return EXIT_FAILURE;
+  }
+
+  /* allocate memory for all dynamic data structures			*/
+  arrive  = (struct timespec *)
+	    malloc ((size_t) nthreads * nphases * sizeof (struct timespec));
+  depart  = (struct timespec *)
+	    malloc ((size_t) nthreads * nphases * sizeof (struct timespec));
+  started = (struct timespec *) malloc (nthreads * sizeof (struct timespec));
+
+  /* Validate that memory was successfully allocated			*/
+  if ((arrive == NULL) || (depart == NULL) || (started == NULL))
+  {
+    fprintf (stderr, "File: %s, line %d: Can't allocate memory.",
+	     __FILE__, __LINE__);
+    exit (EXIT_FAILURE);
+  }
+
+  navail = available_cpus ();
+
+  printf ("\nBarrier benchmark: %d threads, %d phases, %d work per phase, "
+	  "%d available CPUs\n", nthreads, nphases, nwork, navail);
+#ifndef __linux__
+  printf ("CPU affinity not supported, the threads are not pinned\n");
+#endif
+  printf ("\n%-16s %-8s %7s %10s %10s %10s %10s %12s\n", "configuration",
+	  "barrier", "thr/CPU", "p50 (us)", "p90 (us)", "p99 (us)",
+	  "max (us)", "phases/s");
+
+  /* Pinned, one thread per CPU					*/
+  if (nthreads <= navail)
+  {
+    for (i = 0; i < NUM_BARRIERS; i++)
+    {
+      run_barrier (&barrier_types[i], 1, nthreads);
+    }
+  }
+  else
+  {
+    printf ("%-16s skipped, %d threads need %d CPUs, %d available\n",
+	    "pinned", nthreads, nthreads, navail);
+  }
+
+  /* Oversubscribed, two or more threads per CPU			*/
+  oversub = (nthreads / 2 < 1) ? 1 : nthreads / 2;
+  oversub = (oversub > navail) ? navail : oversub;
+  for (i = 0; i < NUM_BARRIERS; i++)
+  {
+    run_barrier (&barrier_types[i], 0, oversub);
+  }
+
+  /* Deallocate any memory or resources associated			*/
+  free (started);
+  free (depart);
+  free (arrive);
+
+  return EXIT_SUCCESS;
+}
+
+
+/* run_barrier runs all the phases with one barrier type and shows the
+ * barrier latency percentiles and the throughput.
+ *
+ * Input:		type		barrier type to measure
+ *			pin		one thread per CPU or more
+ *			cpus		number of CPUs to use, the
+ *					threads go round-robin on them
+ * Return value:	none
+ *
+ */
+void run_barrier (const struct barrier_type *type, int pin, int cpus)
+{
+  int i, p,				/* loop variables		*/
+      err,				/* error number			*/
+      *thr_num;				/* array of thread numbers	*/
+  pthread_t *thr_ids;			/* array of thread ids		*/
+  double *latency,			/* barrier latency per phase	*/
+	 last_in, last_out, t,		/* times of a phase		*/
+	 first, end;			/* times of the whole run	*/
+  char config[32];
+
+  thr_ids = (pthread_t *) malloc (nthreads * sizeof (pthread_t));
+  thr_num = (int *) malloc (nthreads * sizeof (int));
+  latency = (double *) malloc (nphases * sizeof (double));
+  if ((thr_ids == NULL) || (thr_num == NULL) || (latency == NULL))
+  {
+    fprintf (stderr, "File: %s, line %d: Can't allocate memory.",
+	     __FILE__, __LINE__);
+    exit (EXIT_FAILURE);
+  }
+
+  bar_type = type;
+  pinned = pin;
+  ncpus = cpus;
+  atomic_store (&affinity_err, 0);
+  start_state = 0;
+  bar_type->init (nthreads);
+
+  TRACE_THREAD_NAME ("main");
+  TRACE_BEGIN ("create threads");
+  for (i = 0, err = 0; (i < nthreads) && (err == 0); i++)
+  {
+    thr_num[i] = i;			/* Thread number	        */
+    err = pthread_create (&thr_ids[i], NULL, run_phases, &thr_num[i]);
+  }
+  TRACE_END ("create threads");
+
+  /* Let the threads go, or send them home if one couldn't be created,
+   * since the barrier would wait for it forever			*/
+  pthread_mutex_lock (&start_lock);
+  start_state = (err == 0) ? 1 : -1;
+  pthread_cond_broadcast (&start_cond);
+  pthread_mutex_unlock (&start_lock);
+  if (err != 0)
+  {
+    for (p = 0; p < i - 1; p++)
+    {
+      pthread_join (thr_ids[p], NULL);
+    }
+    bar_type->destroy ();
+    snprintf (config, sizeof (config), "%s/%dcpu",
+	      pin ? "pinned" : "oversub", cpus);
+    printf ("%-16s %-8s skipped, can't create thread %d (%s)\n",
+	    config, type->name, i - 1, strerror (err));
+    free (latency);
+    free (thr_num);
+    free (thr_ids);
+    return;
+  }
+
+  /* Using join to syncronize the threads				*/
+  TRACE_BEGIN ("join threads");
+  for (i = 0; i < nthreads; i++)
+  {
+    pthread_join (thr_ids[i], NULL);
+  }
+  TRACE_END ("join threads");
+  bar_type->destroy ();
+
+/* Time in microseconds of a struct timespec				*/
+#define USEC(ts) ((ts).tv_sec * 1e6 + (ts).tv_nsec / 1e3)
+
+  /* The barrier latency of a phase is the time from the last thread
+   * arriving to the barrier until the last thread leaves it		*/
+  first = end = 0;
+  for (p = 0; p < nphases; p++)
+  {
+    last_in = last_out = 0;
+    for (i = 0; i < nthreads; i++)
+    {
+      t = USEC (arrive[i * nphases + p]);
+      last_in = (t > last_in) ? t : last_in;
+      t = USEC (depart[i * nphases + p]);
+      last_out = (t > last_out) ? t : last_out;
+    }
+    latency[p] = last_out - last_in;
+    end = (last_out > end) ? last_out : end;
+  }
+  for (i = 0; i < nthreads; i++)
+  {
+    t = USEC (started[i]);
+    first = ((i == 0) || (t < first)) ? t : first;
+  }
+  qsort (latency, nphases, sizeof (double), cmp_double);
+
+  snprintf (config, sizeof (config), "%s/%dcpu",
+	    pin ? "pinned" : "oversub", cpus);
+  printf ("%-16s %-8s %7.2f %10.2f %10.2f %10.2f %10.2f %12.0f\n",
+	  config, type->name, (double) nthreads / cpus,
+	  latency[(long long) (nphases - 1) * 50 / 100],
+	  latency[(long long) (nphases - 1) * 90 / 100],
+	  latency[(long long) (nphases - 1) * 99 / 100],
+	  latency[nphases - 1],
+	  (end > first) ? nphases / ((end - first) / 1e6) : 0.0);
+  if (atomic_load (&affinity_err) != 0)
+  {
+    printf ("%-16s CPU affinity failed (%s), the threads ran unpinned\n",
+	    "", strerror (atomic_load (&affinity_err)));
+  }
+
+  /* Deallocate any memory or resources associated			*/
+  free (latency);
+  free (thr_num);
+  free (thr_ids);
+}
+
+
+/* run_phases runs as a thread and does the busy work of every phase,
+ * waiting on the barrier between phases. It keeps the time it arrives
+ * to and leaves the barrier on every phase.
+ *
+ * Input:		arg		pointer to current thread number
+ * Return value:	none
+ *
+ */
+void *run_phases (void *arg)
+{
+  int thr_index, p, w, err,
+      sense = 0,			/* local sense of spin barrier	*/
+      no_err = 0;
+  volatile double sink;			/* keep the work from vanishing	*/
+  double x;
+
+  /* Get the index number of current thread				*/
+  thr_index = *( ( int* )arg );
+  err = set_affinity (thr_index);
+  if (err != 0)				/* keep the first failure	*/
+  {
+    atomic_compare_exchange_strong (&affinity_err, &no_err, err);
+  }
+  TRACE_THREAD_NAME ("%s %s %d", pinned ? "pinned" : "oversub",
+		     bar_type->name, thr_index);
+
+  /* Wait until all the threads are created				*/
+  pthread_mutex_lock (&start_lock);
+  while (start_state == 0)
+  {
+    pthread_cond_wait (&start_cond, &start_lock);
+  }
+  pthread_mutex_unlock (&start_lock);
+  if (start_state < 0)
+  {
+    pthread_exit (EXIT_SUCCESS);
+  }
+
+  /* Everybody starts at the same time				*/
+  TRACE_BEGIN ("barrier wait");
+  bar_type->wait (&sense);
+  TRACE_END ("barrier wait");
+  clock_gettime (CLOCK_MONOTONIC, &started[thr_index]);
+
+  x = thr_index;
+  for (p = 0; p < nphases; p++)
+  {
+    TRACE_BEGIN ("work");
+    for (w = 0; w < nwork; w++)		/* configurable busy work	*/
+    {
+      x = x * 1.000001 + 0.5;
+    }
+    sink = x;
+    TRACE_END ("work");
+
+    clock_gettime (CLOCK_MONOTONIC, &arrive[thr_index * nphases + p]);
+    TRACE_BEGIN ("barrier wait");
+    bar_type->wait (&sense);
+    TRACE_END ("barrier wait");
+    clock_gettime (CLOCK_MONOTONIC, &depart[thr_index * nphases + p]);
+  }
+  (void) sink;
+
+  pthread_exit (EXIT_SUCCESS);		/* Terminate the thread		*/
+}
+
+
+/* cmp_double compares two doubles for qsort
+ *
+ * Input:		a, b		pointers to the doubles
+ * Return value:	<0, 0, >0	as a is less, equal or greater
+ *
+ */
+int cmp_double (const void *a, const void *b)
+{
+  double x = *(const double *) a,
+	 y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+
+/* available_cpus finds the CPUs the process may run on, which under
+ * taskset or a container limit are fewer than the online CPUs, and
+ * keeps their ids in cpu_ids.
+ *
+ * Input:		none
+ * Return value:	number of available CPUs
+ *
+ */
+int available_cpus (void)
+{
+  int cpu, n = 0;
+#ifdef __linux__
+  cpu_set_t set;
+
+  if (sched_getaffinity (0, sizeof (set), &set) == 0)
+  {
+    for (cpu = 0; (cpu < CPU_SETSIZE) && (n < CPU_COUNT (&set)); cpu++)
+    {
+      if (CPU_ISSET (cpu, &set))
+      {
+	cpu_ids[n++] = cpu;
+      }
+    }
+  }
+  if (n > 0)
+  {
+    return n;
+  }
+#endif
+
+  /* No affinity mask, use the online CPUs				*/
+  n = (int) sysconf (_SC_NPROCESSORS_ONLN);
+  n = (n < 1) ? 1 : n;
+#ifdef __linux__
+  n = (n > CPU_SETSIZE) ? CPU_SETSIZE : n;
+  for (cpu = 0; cpu < n; cpu++)
+  {
+    cpu_ids[cpu] = cpu;
+  }
+#endif
+  return n;
+}
+
+
+/* set_affinity binds the current thread to one of the first ncpus
+ * available CPUs, round-robin, so every CPU gets the same number of
+ * threads (give or take one). It does nothing where the thread
+ * affinity isn't supported.
+ *
+ * Input:		thr_index	number of current thread
+ * Return value:	0 on success, or the error number
+ *
+ */
+int set_affinity (int thr_index)
+{
+#ifdef __linux__
+  cpu_set_t set;
+
+  CPU_ZERO (&set);
+  CPU_SET (cpu_ids[thr_index % ncpus], &set);
+  return pthread_setaffinity_np (pthread_self (), sizeof (set), &set);
+#else
+  (void) thr_index;
+  return 0;
+#endif
+}
@@ -0,0 +1,950 @@
+/* N-Queens solver library using recursion and backtracing. See
+ * nqueens.h for the interface.
+ *
+ * Every solving thread owns its own placement of the queens and its
+ * own number of solutions, so the threads don't share any data while
+ * they work. With the pthreads engine the rows of the first column
+ * are split among the threads, as queens_pth always did. The only
+ * shared data is the stop flag (cancel or first solution found) and
+ * the number of threads still running.
+ *
+ * The DLX engine builds the exact cover matrix of the puzzle once: one
+ * option per free square, with the row and the column of the square
+ * as primary items, and its two diagonals and the knight moves (for
+ * superqueens) as secondary items. On every solve the first thread
+ * cuts the search at the split depth to get the subtrees (tasks),
+ * while the others wait for it, and then every thread takes the next
+ * task from a shared counter and searches it on its own copy of the
+ * matrix.
+ *
+ * When compiled with -DTRACE, the threads record their work and the
+ * DLX tasks in the timeline of trace.c.
+ *
+ * Compilation (static and shared library)
+ *	gcc -D_BSD_SOURCE -Wall -fPIC -c nqueens.c dlx.c
+ *	ar rcs libnqueens.a nqueens.o dlx.o
+ *	gcc -shared -o libnqueens.so nqueens.o dlx.o -lpthread
+ *
+ *
+ * File: nqueens.c
+ * Date: 18.10.2026
+ */
+
+
+
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "nqueens.h"
+#include "dlx.h"
+#include "trace.h"
+
+#define ITS_SAFE   0			/* queen on a safe position	*/
+#define NOT_SAFE   1			/* or not			*/
+#define CACHE_LINE 64			/* to avoid false sharing	*/
+
+enum nq_state				/* state of a solver		*/
+{
+  NQ_IDLE,				/* ready to solve		*/
+  NQ_RUNNING				/* async solve not waited yet	*/
+};
+
+struct nq_thread			/* private data of one thread	*/
+{
+  nq_solver *solver;			/* solver it works for		*/
+  int index,				/* number of the thread		*/
+      start, end,			/* rows of the first column	*/
+      *queen_on;			/* track positions of the queen */
+  long solutions;			/* solutions found by the thd	*/
+  struct dlx *dlx;			/* own copy of the DLX matrix	*/
+#ifdef PERF_COUNTERS
+  struct nq_stats stats;		/* backtracking statistics	*/
+#endif
+  pthread_t id;				/* thread id			*/
+  char pad[CACHE_LINE];			/* keep threads apart		*/
+};
+
+struct nq_solver
+{
+  struct nq_config config;		/* copy of the configuration	*/
+  int nthreads,				/* number of solving threads	*/
+      state;				/* idle or running		*/
+  struct nq_thread *thr;		/* array of solving threads	*/
+  struct dlx *matrix;			/* DLX matrix of the puzzle	*/
+  int *opt_row, *opt_col,		/* square of every DLX option	*/
+      *tasks,				/* options chosen by every task	*/
+      *task_len,			/* and how many			*/
+      ntasks, maxtasks,			/* used and allocated tasks	*/
+      task_error,			/* no memory to split		*/
+      split_done;			/* tasks ready for the threads	*/
+  pthread_mutex_t split_lock;		/* protects split_done		*/
+  pthread_cond_t split_cond;		/* signals split_done		*/
+  atomic_int stop,			/* cancel or first solution	*/
+	     running,			/* threads still working	*/
+	     next_task;			/* next DLX task to search	*/
+};
+
+
+static void *start_thread (void *);
+static void solve_thread (struct nq_thread *);
+static void nqueens (struct nq_thread *, int);
+static int is_safe (struct nq_thread *, int, int, int);
+static void found_solution (struct nq_thread *);
+static int build_matrix (nq_solver *);
+static void split_tasks (struct nq_thread *);
+static void add_task (const int *, int, int, void *);
+static void dlx_thread (struct nq_thread *);
+static void dlx_solution (const int *, int, int, void *);
+
+
+/* nq_config_init sets a configuration to its default values: eight
+ * queens counted by one thread without callbacks, on a plain board.
+ *
+ * Input:		config		configuration to initialize
+ * Return value:	none
+ *
+ */
+void nq_config_init (struct nq_config *config)
+{
+  config->nq = NQ_NUM_QUEENS;
+  config->nthreads = 1;
+  config->engine = NQ_ENGINE_SEQUENTIAL;
+  config->mode = NQ_MODE_COUNT;
+  config->variant = NQ_VARIANT_QUEENS;
+  config->blocked = NULL;
+  config->nblocked = 0;
+  config->split_depth = NQ_SPLIT_DEPTH;
+  config->on_solution = NULL;
+  config->on_thread_start = NULL;
+  config->on_thread_stop = NULL;
+  config->arg = NULL;
+}
+
+
+/* nq_create validates a configuration and allocates a solver with all
+ * its dynamic data structures. The configuration is copied.
+ *
+ * Input:		solver		where to store the new handle
+ *			config		configuration of the solves
+ * Return value:	0		success
+ *			EINVAL		wrong configuration
+ *			ENOMEM		can't allocate memory
+ *
+ */
+int nq_create (nq_solver **solver, const struct nq_config *config)
+{
+  nq_solver *s;
+  int i, nthreads;
+
+  if ((solver == NULL) || (config == NULL) || (config->nq < 1))
+  {
+    return EINVAL;
+  }
+  /* Variants and blocked squares need the DLX engine			*/
+  if (((config->variant != NQ_VARIANT_QUEENS) || (config->nblocked > 0)) &&
+      (config->engine != NQ_ENGINE_DLX))
+  {
+    return EINVAL;
+  }
+  if ((config->variant & ~(NQ_VARIANT_TOROIDAL | NQ_VARIANT_SUPER)) ||
+      (config->nblocked < 0) ||
+      ((config->nblocked > 0) && (config->blocked == NULL)))
+  {
+    return EINVAL;
+  }
+  for (i = 0; i < 2 * config->nblocked; i++)
+  {
+    if ((config->blocked[i] < 0) || (config->blocked[i] >= config->nq))
+    {
+      return EINVAL;
+    }
+  }
+  switch (config->engine)
+  {
+    case NQ_ENGINE_SEQUENTIAL:
+      nthreads = 1;
+      break;
+
+    case NQ_ENGINE_PTHREADS:
+      /* Every thread needs at least one row of the first column	*/
+      nthreads = config->nthreads;
+      if ((nthreads < 1) || (nthreads > config->nq))
+      {
+	return EINVAL;
+      }
+      break;
+
+    case NQ_ENGINE_DLX:
+      /* Tasks are taken from a queue, any number of threads works	*/
+      nthreads = config->nthreads;
+      if ((nthreads < 1) || (config->split_depth < 0))
+      {
+	return EINVAL;
+      }
+      break;
+
+    default:
+      return EINVAL;
+  }
+  if ((config->mode != NQ_MODE_COUNT) && (config->mode != NQ_MODE_FIRST))
+  {
+    return EINVAL;
+  }
+
+  /* allocate memory for all dynamic data structures and validate them	*/
+  s = (nq_solver *) calloc (1, sizeof (nq_solver));
+  if (s == NULL)
+  {
+    return ENOMEM;
+  }
+  s->thr = (struct nq_thread *) calloc (nthreads, sizeof (struct nq_thread));
+  if (s->thr == NULL)
+  {
+    free (s);
+    return ENOMEM;
+  }
+  pthread_mutex_init (&s->split_lock, NULL);
+  pthread_cond_init (&s->split_cond, NULL);
+
+  s->config = *config;
+  s->config.nthreads = s->nthreads = nthreads;
+  /* A solution has nq options, a split at nq is the whole tree	*/
+  if (s->config.split_depth > config->nq)
+  {
+    s->config.split_depth = config->nq;
+  }
+  s->state = NQ_IDLE;
+  atomic_init (&s->stop, 0);
+  atomic_init (&s->running, 0);
+
+  for (i = 0; i < nthreads; i++)
+  {
+    s->thr[i].solver = s;
+    s->thr[i].index = i;
+    /* start/end point to cover all rows of the first column		*/
+    s->thr[i].start = i * (config->nq / nthreads);
+    s->thr[i].end = (i == nthreads - 1) ?
+		    config->nq - 1 : (i + 1) * (config->nq / nthreads) - 1;
+    s->thr[i].queen_on = (int *) calloc (config->nq, sizeof (int));
+    if (s->thr[i].queen_on == NULL)
+    {
+      nq_destroy (s);
+      return ENOMEM;
+    }
+  }
+
+  /* Exact cover matrix and a copy for every thread			*/
+  if (config->engine == NQ_ENGINE_DLX)
+  {
+    if (build_matrix (s) != 0)
+    {
+      nq_destroy (s);
+      return ENOMEM;
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+      s->thr[i].dlx = dlx_copy (s->matrix);
+      if (s->thr[i].dlx == NULL)
+      {
+	nq_destroy (s);
+	return ENOMEM;
+      }
+    }
+  }
+
+  *solver = s;
+  return 0;
+}
+
+
+/* nq_solve solves the puzzle and returns when it's done. The
+ * sequential engine runs in the calling thread.
+ *
+ * Input:		solver		solver handle
+ * Return value:	0		success
+ *			EBUSY		an async solve is running
+ *			ENOMEM		no memory to split the DLX search
+ *			other		error creating the threads
+ *
+ */
+int nq_solve (nq_solver *solver)
+{
+  int err;
+
+  if (solver->state == NQ_RUNNING)
+  {
+    return EBUSY;
+  }
+
+  if (solver->config.engine == NQ_ENGINE_SEQUENTIAL)
+  {
+    atomic_store (&solver->stop, 0);
+    solve_thread (&solver->thr[0]);
+    return 0;
+  }
+
+  err = nq_solve_async (solver);
+  if (err != 0)
+  {
+    return err;
+  }
+  return nq_wait (solver);
+}
+
+
+/* nq_solve_async creates the solving threads and returns right away.
+ * The solve has to be finished with nq_wait before reading the
+ * results, even if nq_done says it's done.
+ *
+ * Input:		solver		solver handle
+ * Return value:	0		success
+ *			EBUSY		an async solve is running
+ *			other		error creating the threads
+ *
+ */
+int nq_solve_async (nq_solver *solver)
+{
+  int i, j, err;
+
+  if (solver->state == NQ_RUNNING)
+  {
+    return EBUSY;
+  }
+
+  atomic_store (&solver->stop, 0);
+  atomic_store (&solver->running, solver->nthreads);
+  atomic_store (&solver->next_task, 0);
+  solver->split_done = 0;
+
+  /* Create the threads	and let them do their work		  	*/
+  TRACE_BEGIN ("create threads");
+  for (i = 0; i < solver->nthreads; i++)
+  {
+    err = pthread_create (&solver->thr[i].id, NULL, start_thread,
+			  &solver->thr[i]);
+    if (err != 0)
+    {
+      /* Stop and collect the threads that did start			*/
+      atomic_store (&solver->stop, 1);
+      for (j = 0; j < i; j++)
+      {
+	pthread_join (solver->thr[j].id, NULL);
+      }
+      atomic_store (&solver->running, 0);
+      TRACE_END ("create threads");
+      return err;
+    }
+  }
+  TRACE_END ("create threads");
+
+  solver->state = NQ_RUNNING;
+  return 0;
+}
+
+
+/* nq_done tells whether all the solving threads have finished
+ *
+ * Input:		solver		solver handle
+ * Return value:	1		no thread is working
+ *			0		the solve is still running
+ *
+ */
+int nq_done (nq_solver *solver)
+{
+  return (solver->state != NQ_RUNNING) ||
+	 (atomic_load (&solver->running) == 0);
+}
+
+
+/* nq_wait waits for an async solve to finish. It returns right away
+ * if no async solve is running.
+ *
+ * Input:		solver		solver handle
+ * Return value:	0		success
+ *			ENOMEM		no memory to split the DLX search
+ *
+ */
+int nq_wait (nq_solver *solver)
+{
+  int i;
+
+  if (solver->state != NQ_RUNNING)
+  {
+    return 0;
+  }
+
+  /* Using join to syncronize the threads				*/
+  TRACE_BEGIN ("join threads");
+  for (i = 0; i < solver->nthreads; i++)
+  {
+    pthread_join (solver->thr[i].id, NULL);
+  }
+  TRACE_END ("join threads");
+  solver->state = NQ_IDLE;
+
+  return solver->task_error ? ENOMEM : 0;
+}
+
+
+/* nq_cancel asks the solving threads to stop as soon as possible. It
+ * can be called from any thread, including the callbacks. The number
+ * of solutions of a cancelled solve is partial.
+ *
+ * Input:		solver		solver handle
+ * Return value:	0		success
+ *
+ */
+int nq_cancel (nq_solver *solver)
+{
+  atomic_store (&solver->stop, 1);
+  return 0;
+}
+
+
+/* nq_solutions sums the solutions found by all the threads
+ *
+ * Input:		solver		solver handle
+ * Return value:	total number of solutions of the last solve
+ *
+ */
+long nq_solutions (const nq_solver *solver)
+{
+  int i;
+  long total;
+
+  for (i = 0, total = 0; i < solver->nthreads; i++)
+  {
+    total += solver->thr[i].solutions;
+  }
+
+  return total;
+}
+
+
+/* nq_nthreads returns the number of solving threads, which is one for
+ * the sequential engine.
+ *
+ * Input:		solver		solver handle
+ * Return value:	number of solving threads
+ *
+ */
+int nq_nthreads (const nq_solver *solver)
+{
+  return solver->nthreads;
+}
+
+
+/* nq_thread_solutions returns the solutions found by one thread
+ *
+ * Input:		solver		solver handle
+ *			thr_index	number of the thread
+ * Return value:	number of solutions, or -1 if there's no such thread
+ *
+ */
+long nq_thread_solutions (const nq_solver *solver, int thr_index)
+{
+  if ((thr_index < 0) || (thr_index >= solver->nthreads))
+  {
+    return -1;
+  }
+
+  return solver->thr[thr_index].solutions;
+}
+
+
+/* nq_thread_stats copies the backtracking statistics of one thread
+ *
+ * Input:		solver		solver handle
+ *			thr_index	number of the thread
+ *			stats		where to copy them
+ * Return value:	0		success
+ *			EINVAL		there's no such thread
+ *			ENOTSUP		not compiled with -DPERF_COUNTERS,
+ *					the statistics are all zero
+ *
+ */
+int nq_thread_stats (const nq_solver *solver, int thr_index,
+		     struct nq_stats *stats)
+{
+  if ((thr_index < 0) || (thr_index >= solver->nthreads))
+  {
+    return EINVAL;
+  }
+
+#ifdef PERF_COUNTERS
+  *stats = solver->thr[thr_index].stats;
+  return 0;
+#else
+  stats->checks = stats->conflicts = stats->placed = 0;
+  return ENOTSUP;
+#endif
+}
+
+
+/* nq_destroy deallocates a solver and all the resources associated.
+ * A running async solve is cancelled and waited for first.
+ *
+ * Input:		solver		solver handle
+ * Return value:	none
+ *
+ */
+void nq_destroy (nq_solver *solver)
+{
+  int i;
+
+  if (solver == NULL)
+  {
+    return;
+  }
+  if (solver->state == NQ_RUNNING)
+  {
+    nq_cancel (solver);
+    nq_wait (solver);
+  }
+
+  for (i = 0; i < solver->nthreads; i++)
+  {
+    free (solver->thr[i].queen_on);
+    dlx_destroy (solver->thr[i].dlx);
+  }
+  dlx_destroy (solver->matrix);
+  free (solver->opt_row);
+  free (solver->opt_col);
+  free (solver->tasks);
+  free (solver->task_len);
+  pthread_cond_destroy (&solver->split_cond);
+  pthread_mutex_destroy (&solver->split_lock);
+  free (solver->thr);
+  free (solver);
+}
+
+
+/* start_thread runs as a peer thread and will execute the nqueens
+ * function concurrently to find the number of possible solutions
+ *
+ * Input:		arg		pointer to the thread data
+ * Return value:	none
+ *
+ */
+static void *start_thread (void *arg)
+{
+  struct nq_thread *thr = (struct nq_thread *) arg;
+
+  solve_thread (thr);
+  atomic_fetch_sub (&thr->solver->running, 1);
+
+  pthread_exit (EXIT_SUCCESS);		/* Terminate the thread		*/
+}
+
+
+/* solve_thread finds the solutions of one thread, calling the thread
+ * start/stop callbacks around the work.
+ *
+ * Input:		thr		thread data
+ * Return value:	none
+ *
+ */
+static void solve_thread (struct nq_thread *thr)
+{
+  const struct nq_config *config = &thr->solver->config;
+
+  /* Set start number of solutions for current thread			*/
+  thr->solutions = 0;
+#ifdef PERF_COUNTERS
+  thr->stats.checks = thr->stats.conflicts = thr->stats.placed = 0;
+#endif
+
+  TRACE_THREAD_NAME ("nqueens %d", thr->index);
+  TRACE_BEGIN ("solve");
+  if (config->on_thread_start != NULL)
+  {
+    config->on_thread_start (thr->index, config->arg);
+  }
+  /* Release the Kraken!						*/
+  if (config->engine == NQ_ENGINE_DLX)
+  {
+    dlx_thread (thr);
+  }
+  else
+  {
+    nqueens (thr, 0);
+  }
+  TRACE_END ("solve");
+  if (config->on_thread_stop != NULL)
+  {
+    config->on_thread_stop (thr->index, config->arg);
+  }
+}
+
+
+/* nqueens calculates the total number of solutions using recursion
+ * and backtracing.
+ *
+ * Input:		thr		current thread
+ *			col		column of the board
+ * Return value:	none
+ *
+ */
+static void nqueens (struct nq_thread *thr, int col)
+{
+  nq_solver *s = thr->solver;
+  int i, j,				/* loop variables		*/
+      start, end,			/* position variables		*/
+      nq = s->config.nq;		/* number of queens		*/
+
+  if (col == nq)			/* tried N queens permutations  */
+  {
+    found_solution (thr);
+    return;
+  }
+
+  /* start/end point to cover all rows					*/
+  start = (col > 0) ? 0 : thr->start;
+  end	= (col > 0) ? nq - 1 : thr->end;
+
+  /* Backtracking - try next column on recursive call for current thd	*/
+  for (i = start; i <= end; i++)
+  {
+    if (atomic_load_explicit (&s->stop, memory_order_relaxed))
+    {
+      return;
+    }
+    for (j = 0; j < col && is_safe (thr, i, j, col); j++);
+    if (j < col)
+    {
+#ifdef PERF_COUNTERS
+      thr->stats.conflicts++;
+#endif
+      continue;
+    }
+#ifdef PERF_COUNTERS
+    thr->stats.placed++;
+#endif
+    thr->queen_on[col] = i;
+    nqueens (thr, col + 1);
+  }
+}
+
+
+/* is_safe determines if a queen does not attack other
+ *
+ * Input:		thr		current thread
+ *			i, j		board coordinates
+ *			col		column of the board
+ * Return value:	ITS_SAFE	Queen without problems
+ *			NOT_SAFE	Queen under attack!
+ *
+ */
+static int is_safe (struct nq_thread *thr, int i, int j, int col)
+{
+#ifdef PERF_COUNTERS
+  thr->stats.checks++;
+#endif
+  if (thr->queen_on[j] == i)
+  {
+    return ITS_SAFE;
+  }
+  if (abs (thr->queen_on[j] - i) == col - j)
+  {
+    return ITS_SAFE;
+  }
+
+  return NOT_SAFE;
+}
+
+
+/* found_solution counts the solution on the placement of the thread
+ * and calls the solution callback. If only the first solution is
+ * wanted, the thread has to claim it by setting the stop flag first,
+ * so a solution found at the same time by another thread (or after a
+ * cancel) isn't reported.
+ *
+ * Input:		thr		current thread
+ * Return value:	none
+ *
+ */
+static void found_solution (struct nq_thread *thr)
+{
+  nq_solver *s = thr->solver;
+
+  if ((s->config.mode == NQ_MODE_FIRST) && atomic_exchange (&s->stop, 1))
+  {
+    return;				/* somebody else was first	*/
+  }
+  thr->solutions++;			/* peer found one solution 	*/
+  if (s->config.on_solution != NULL)
+  {
+    s->config.on_solution (thr->queen_on, s->config.nq, thr->index,
+			   s->config.arg);
+  }
+}
+
+
+/* build_matrix builds the exact cover matrix of the puzzle. Items are
+ * numbered as rows, columns (primary), diagonals, anti-diagonals and
+ * knight moves (secondary). A toroidal board has N diagonals of every
+ * direction instead of 2N-1, and its knight moves wrap around too.
+ *
+ * Input:		s		solver with the configuration
+ * Return value:	0 on success, 1 if there's no memory
+ *
+ */
+static int build_matrix (nq_solver *s)
+{
+  static const int moves[4][2] = { { 1, 2 }, { 1, -2 }, { 2, 1 }, { 2, -1 } };
+  int n = s->config.nq,
+      torus = (s->config.variant & NQ_VARIANT_TOROIDAL) != 0,
+      super = (s->config.variant & NQ_VARIANT_SUPER) != 0,
+      ndiag = torus ? n : 2 * n - 1,	/* diagonals of every direction	*/
+      nknight = 0,			/* knight moves on the board	*/
+      *knight = NULL,			/* 8 knight moves per square	*/
+      *nmoves = NULL,			/* knight moves of every square	*/
+      items[4 + 8],			/* items of one option		*/
+      i, r, c, r2, c2, m, k, o, err = 1;
+  char *blocked = NULL;			/* squares without queens	*/
+
+  blocked = (char *) calloc (n * n, sizeof (char));
+  nmoves = (int *) calloc (n * n, sizeof (int));
+  knight = (int *) malloc (8 * n * n * sizeof (int));
+  s->opt_row = (int *) malloc (n * n * sizeof (int));
+  s->opt_col = (int *) malloc (n * n * sizeof (int));
+  if ((blocked == NULL) || (nmoves == NULL) || (knight == NULL) ||
+      (s->opt_row == NULL) || (s->opt_col == NULL))
+  {
+    goto out;
+  }
+  for (i = 0; i < s->config.nblocked; i++)
+  {
+    blocked[s->config.blocked[2 * i] * n + s->config.blocked[2 * i + 1]] = 1;
+  }
+
+  /* Every pair of squares a knight move apart gets its own secondary
+   * item, so at most one of them has a queen. Only the moves forward
+   * are followed, to see every pair once.				*/
+  for (r = 0; super && (r < n); r++)
+  {
+    for (c = 0; c < n; c++)
+    {
+      for (m = 0; m < 4; m++)
+      {
+	r2 = r + moves[m][0];
+	c2 = c + moves[m][1];
+	if (torus)
+	{
+	  r2 = r2 % n;
+	  c2 = (c2 + 2 * n) % n;
+	}
+	if ((r2 >= n) || (c2 < 0) || (c2 >= n) || ((r2 == r) && (c2 == c)))
+	{
+	  continue;
+	}
+	knight[8 * (r * n + c) + nmoves[r * n + c]++] = nknight;
+	knight[8 * (r2 * n + c2) + nmoves[r2 * n + c2]++] = nknight;
+	nknight++;
+      }
+    }
+  }
+
+  s->matrix = dlx_create (2 * n, 2 * ndiag + nknight);
+  if (s->matrix == NULL)
+  {
+    goto out;
+  }
+
+  /* One option per free square					*/
+  for (r = 0; r < n; r++)
+  {
+    for (c = 0; c < n; c++)
+    {
+      if (blocked[r * n + c])
+      {
+	continue;
+      }
+      items[0] = r;
+      items[1] = n + c;
+      items[2] = 2 * n + (torus ? (r - c + n) % n : r - c + n - 1);
+      items[3] = 2 * n + ndiag + (torus ? (r + c) % n : r + c);
+      for (k = 0; k < nmoves[r * n + c]; k++)
+      {
+	items[4 + k] = 2 * n + 2 * ndiag + knight[8 * (r * n + c) + k];
+      }
+      o = dlx_add_option (s->matrix, items, 4 + nmoves[r * n + c]);
+      if (o < 0)
+      {
+	goto out;
+      }
+      s->opt_row[o] = r;
+      s->opt_col[o] = c;
+    }
+  }
+  err = 0;
+
+out:
+  free (blocked);
+  free (nmoves);
+  free (knight);
+  return err;
+}
+
+
+/* split_tasks cuts the DLX search at the split depth into the task
+ * list. The first thread does it on its own matrix, and can be
+ * stopped by nq_cancel; the other threads wait until it's done.
+ *
+ * Input:		thr		current thread
+ * Return value:	none
+ *
+ */
+static void split_tasks (struct nq_thread *thr)
+{
+  nq_solver *s = thr->solver;
+
+  if (thr->index == 0)
+  {
+    TRACE_BEGIN ("split");
+    s->ntasks = 0;
+    s->task_error = 0;
+    dlx_search (thr->dlx, s->config.split_depth, add_task, s, &s->stop);
+    if (s->task_error)
+    {
+      atomic_store (&s->stop, 1);
+    }
+    TRACE_END ("split");
+
+    pthread_mutex_lock (&s->split_lock);
+    s->split_done = 1;
+    pthread_cond_broadcast (&s->split_cond);
+    pthread_mutex_unlock (&s->split_lock);
+  }
+  else
+  {
+    TRACE_BEGIN ("wait split");
+    pthread_mutex_lock (&s->split_lock);
+    while (!s->split_done)
+    {
+      pthread_cond_wait (&s->split_cond, &s->split_lock);
+    }
+    pthread_mutex_unlock (&s->split_lock);
+    TRACE_END ("wait split");
+  }
+}
+
+
+/* add_task is called while splitting the DLX search, and keeps every
+ * partial solution at the split depth as a task. Complete solutions
+ * found before that depth are kept as tasks too, their search finds
+ * the solution right away.
+ *
+ * Input:		options		options chosen by the task
+ *			noptions	number of options
+ *			complete	solution or subtree
+ *			arg		solver
+ * Return value:	none
+ *
+ */
+static void add_task (const int *options, int noptions, int complete,
+		      void *arg)
+{
+  nq_solver *s = (nq_solver *) arg;
+  int k, depth = s->config.split_depth;
+
+  (void) complete;
+  if (s->task_error)
+  {
+    return;
+  }
+  if (s->ntasks == s->maxtasks)
+  {
+    int n = (s->maxtasks > 0) ? 2 * s->maxtasks : CACHE_LINE,
+	*tasks = s->tasks,
+	*task_len;
+
+    if (depth > 0)
+    {
+      tasks = (int *) realloc (s->tasks, n * depth * sizeof (int));
+      if (tasks == NULL)
+      {
+	s->task_error = 1;
+	return;
+      }
+      s->tasks = tasks;
+    }
+    task_len = (int *) realloc (s->task_len, n * sizeof (int));
+    if (task_len == NULL)
+    {
+      s->task_error = 1;
+      return;
+    }
+    s->task_len = task_len;
+    s->maxtasks = n;
+  }
+
+  for (k = 0; k < noptions; k++)
+  {
+    s->tasks[s->ntasks * depth + k] = options[k];
+  }
+  s->task_len[s->ntasks++] = noptions;
+}
+
+
+/* dlx_thread takes DLX tasks from the queue, once they are split,
+ * until there are no more, choosing the options of the task on its
+ * own matrix and searching the rest of the subtree.
+ *
+ * Input:		thr		current thread
+ * Return value:	none
+ *
+ */
+static void dlx_thread (struct nq_thread *thr)
+{
+  nq_solver *s = thr->solver;
+  int t, k;
+
+  split_tasks (thr);
+  while (!atomic_load_explicit (&s->stop, memory_order_relaxed))
+  {
+    t = atomic_fetch_add (&s->next_task, 1);
+    if (t >= s->ntasks)
+    {
+      break;
+    }
+    TRACE_BEGIN ("task");
+    for (k = 0; k < s->task_len[t]; k++)
+    {
+      dlx_choose (thr->dlx, s->tasks[t * s->config.split_depth + k]);
+    }
+    dlx_search (thr->dlx, -1, dlx_solution, thr, &s->stop);
+    for (k = 0; k < s->task_len[t]; k++)
+    {
+      dlx_unchoose (thr->dlx);
+    }
+    TRACE_END ("task");
+  }
+}
+
+
+/* dlx_solution turns the options of a DLX solution into the placement
+ * of the queens of the thread.
+ *
+ * Input:		options		options of the solution
+ *			noptions	number of options
+ *			complete	always 1, there's no maximum depth
+ *			arg		current thread
+ * Return value:	none
+ *
+ */
+static void dlx_solution (const int *options, int noptions, int complete,
+			  void *arg)
+{
+  struct nq_thread *thr = (struct nq_thread *) arg;
+  int k;
+
+  (void) complete;
+  for (k = 0; k < noptions; k++)
+  {
+    thr->queen_on[thr->solver->opt_col[options[k]]] =
+      thr->solver->opt_row[options[k]];
+  }
+  found_solution (thr);
+}
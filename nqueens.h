@@ -0,0 +1,117 @@
+/* N-Queens solver library. It keeps all the state of a solve in a
+ * solver handle instead of global variables, so several solves can
+ * run in the same process (e.g. a service) without fork/exec. The
+ * queens and queens_pth programs are thin command-line interfaces
+ * over it.
+ *
+ * A solve is configured with a struct nq_config (number of queens,
+ * number of threads, engine and mode) and can be run blocking with
+ * nq_solve, or in the background with nq_solve_async and nq_wait. An
+ * optional callback is called for every solution found with a pointer
+ * to the placement of the thread that found it; the placement is not
+ * copied, so it's only valid during the call.
+ *
+ * Besides the plain puzzle, the DLX engine solves variants that the
+ * backtracking engines can't express: toroidal queens (diagonals wrap
+ * around the board), superqueens (queens that also move as knights)
+ * and boards with blocked squares. It solves the puzzle as an exact
+ * cover problem with Knuth's Algorithm X and Dancing Links (dlx.c),
+ * split into subtrees at a configurable depth that the threads take
+ * from a shared queue.
+ *
+ * All the functions returning int return 0 on success or an error
+ * number (as the pthread functions do), which can be shown with
+ * strerror.
+ *
+ * Compilation (static and shared library)
+ *	gcc -D_BSD_SOURCE -Wall -fPIC -c nqueens.c dlx.c
+ *	ar rcs libnqueens.a nqueens.o dlx.o
+ *	gcc -shared -o libnqueens.so nqueens.o dlx.o -lpthread
+ *
+ *
+ * File: nqueens.h
+ * Date: 18.10.2026
+ */
+
+
+#ifndef NQUEENS_H
+#define NQUEENS_H
+
+#define NQ_NUM_QUEENS	8		/* default number of queens	*/
+#define NQ_SPLIT_DEPTH	3		/* default DLX subtree depth	*/
+
+enum nq_engine				/* how the solve is run		*/
+{
+  NQ_ENGINE_SEQUENTIAL,			/* one thread, whole board	*/
+  NQ_ENGINE_PTHREADS,			/* rows of the first column 	*/
+					/* split among the threads	*/
+  NQ_ENGINE_DLX				/* exact cover, subtrees split	*/
+					/* among the threads		*/
+};
+
+enum nq_variant				/* rules, DLX engine only	*/
+{
+  NQ_VARIANT_QUEENS   = 0,		/* plain N-Queens		*/
+  NQ_VARIANT_TOROIDAL = 1,		/* diagonals wrap around	*/
+  NQ_VARIANT_SUPER    = 2		/* queens move as knights too	*/
+};
+
+enum nq_mode				/* when the solve ends		*/
+{
+  NQ_MODE_COUNT,			/* find all the solutions	*/
+  NQ_MODE_FIRST				/* stop at the first solution	*/
+};
+
+/* Called by the thread that found a solution. queen_on[col] is the
+ * row of the queen on column col, for nq columns.			*/
+typedef void (*nq_solution_fn) (const int *queen_on, int nq,
+				int thr_index, void *arg);
+
+/* Called by every solving thread right before and after its work	*/
+typedef void (*nq_thread_fn) (int thr_index, void *arg);
+
+struct nq_config
+{
+  int nq;				/* number of queens		*/
+  int nthreads;				/* number of threads		*/
+  enum nq_engine engine;		/* sequential, pthreads or DLX	*/
+  enum nq_mode mode;			/* count all or first only	*/
+  unsigned int variant;			/* NQ_VARIANT_ flags (or-ed)	*/
+  const int *blocked;			/* row, col pairs of squares	*/
+  int nblocked;				/* without queens (DLX only),	*/
+					/* only read by nq_create	*/
+  int split_depth;			/* DLX subtree depth >= 0,	*/
+					/* clamped to nq		*/
+  nq_solution_fn on_solution;		/* optional, per solution	*/
+  nq_thread_fn on_thread_start;		/* optional, per thread		*/
+  nq_thread_fn on_thread_stop;		/* optional, per thread		*/
+  void *arg;				/* passed to the callbacks	*/
+};
+
+/* Statistics of the backtracking loop of one thread. Only collected
+ * when the library is compiled with -DPERF_COUNTERS, which adds the
+ * increments to the loop itself.					*/
+struct nq_stats
+{
+  unsigned long long checks,		/* calls to is_safe		*/
+		     conflicts,		/* positions under attack	*/
+		     placed;		/* positions tried recursively	*/
+};
+
+typedef struct nq_solver nq_solver;	/* opaque solver handle		*/
+
+
+void nq_config_init (struct nq_config *);
+int nq_create (nq_solver **, const struct nq_config *);
+int nq_solve (nq_solver *);
+int nq_solve_async (nq_solver *);
+int nq_done (nq_solver *);
+int nq_wait (nq_solver *);
+int nq_cancel (nq_solver *);
+long nq_solutions (const nq_solver *);
+int nq_nthreads (const nq_solver *);
+long nq_thread_solutions (const nq_solver *, int);
+int nq_thread_stats (const nq_solver *, int, struct nq_stats *);
+void nq_destroy (nq_solver *);
+
+#endif
@@ -0,0 +1,336 @@
+/* Per-thread hardware performance counters based on the Linux
+ * perf_event_open system call. See perf_counters.h for the interface.
+ *
+ * Every event is opened on its own (not as a group), so a missing
+ * event doesn't disable the others. Counts are scaled by the
+ * enabled/running times in case the kernel had to multiplex them.
+ *
+ *
+ * File: perf_counters.c
+ * Date: 18.10.2026
+ */
+
+
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+
+static const char *pc_names[PC_NUM_EVENTS] =
+{
+  "cycles", "instructions", "branches", "branch-misses",
+  "L1D-misses", "LLC-misses"
+};
+
+
+/* perf_counters_clear resets all counts and marks every event as
+ * available, so it can be used as the starting point of a sum.
+ *
+ * Input:		pc		counters to reset
+ * Return value:	none
+ *
+ */
+void perf_counters_clear (struct perf_counters *pc)
+{
+  int e;
+
+  for (e = 0; e < PC_NUM_EVENTS; e++)
+  {
+    pc->fd[e] = -1;
+    pc->available[e] = 1;
+    pc->count[e] = 0;
+  }
+  pc->error = 0;
+}
+
+
+#ifdef __linux__
+/* pc_open opens one counter for the calling thread on any CPU. The
+ * counter is created disabled and only counts user space.
+ *
+ * Input:		type, config	perf event type and config
+ * Return value:	file descriptor, or -1 and errno on failure
+ *
+ */
+static int pc_open (unsigned int type, unsigned long long config)
+{
+  struct perf_event_attr attr;
+
+  memset (&attr, 0, sizeof (attr));
+  attr.size = sizeof (attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+		     PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return (int) syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+
+/* perf_counters_start opens and enables all the counters for the
+ * calling thread. The counters that can't be opened are marked as
+ * unavailable and the errno of the first failure is kept.
+ *
+ * Input:		pc		counters of the current thread
+ * Return value:	number of available counters
+ *
+ */
+int perf_counters_start (struct perf_counters *pc)
+{
+  int e, navailable;
+
+  perf_counters_clear (pc);
+  navailable = 0;
+
+#ifdef __linux__
+  {
+    static const unsigned int type[PC_NUM_EVENTS] =
+    {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+      PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+    };
+    static const unsigned long long config[PC_NUM_EVENTS] =
+    {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_MISSES,
+      PERF_COUNT_HW_CACHE_L1D |
+	(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+	(PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_MISSES
+    };
+
+    for (e = 0; e < PC_NUM_EVENTS; e++)
+    {
+      pc->fd[e] = pc_open (type[e], config[e]);
+      if (pc->fd[e] < 0)
+      {
+	pc->available[e] = 0;
+	if (pc->error == 0)
+	{
+	  pc->error = errno;
+	}
+	continue;
+      }
+      navailable++;
+    }
+
+    /* Enable them as close as possible to the measured code		*/
+    for (e = 0; e < PC_NUM_EVENTS; e++)
+    {
+      if (pc->available[e])
+      {
+	ioctl (pc->fd[e], PERF_EVENT_IOC_RESET, 0);
+	ioctl (pc->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+#else
+  for (e = 0; e < PC_NUM_EVENTS; e++)
+  {
+    pc->available[e] = 0;
+  }
+  pc->error = ENOSYS;
+#endif
+
+  return navailable;
+}
+
+
+/* perf_counters_stop disables the counters of the calling thread,
+ * reads their (scaled) values and closes them.
+ *
+ * Input:		pc		counters of the current thread
+ * Return value:	none
+ *
+ */
+void perf_counters_stop (struct perf_counters *pc)
+{
+#ifdef __linux__
+  int e;
+  unsigned long long value[3];		/* count, enabled, running	*/
+
+  for (e = 0; e < PC_NUM_EVENTS; e++)
+  {
+    if (pc->available[e])
+    {
+      ioctl (pc->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+
+  for (e = 0; e < PC_NUM_EVENTS; e++)
+  {
+    if (!pc->available[e])
+    {
+      continue;
+    }
+    if (read (pc->fd[e], value, sizeof (value)) != sizeof (value) ||
+	value[2] == 0)
+    {
+      /* Never scheduled on the PMU, the count means nothing		*/
+      pc->available[e] = 0;
+    }
+    else if (value[2] < value[1])
+    {
+      pc->count[e] = (unsigned long long)
+		     ((double) value[0] * value[1] / value[2]);
+    }
+    else
+    {
+      pc->count[e] = value[0];
+    }
+    close (pc->fd[e]);
+    pc->fd[e] = -1;
+  }
+#else
+  (void) pc;
+#endif
+}
+
+
+/* perf_counters_add accumulates the counts of one thread into a total.
+ * An event is only available in the total if it was available in all
+ * the threads added to it.
+ *
+ * Input:		total		accumulated counters
+ *			pc		counters of one thread
+ * Return value:	none
+ *
+ */
+void perf_counters_add (struct perf_counters *total,
+			const struct perf_counters *pc)
+{
+  int e;
+
+  for (e = 0; e < PC_NUM_EVENTS; e++)
+  {
+    total->available[e] = total->available[e] && pc->available[e];
+    total->count[e] += pc->count[e];
+  }
+  if (total->error == 0)
+  {
+    total->error = pc->error;
+  }
+}
+
+
+/* perf_counters_available tells whether at least one counter worked
+ *
+ * Input:		pc		counters to check
+ * Return value:	number of available counters
+ *
+ */
+int perf_counters_available (const struct perf_counters *pc)
+{
+  int e, navailable;
+
+  for (e = navailable = 0; e < PC_NUM_EVENTS; e++)
+  {
+    navailable += pc->available[e];
+  }
+
+  return navailable;
+}
+
+
+/* perf_counters_print shows the raw counts in one line, followed by
+ * the derived IPC and branch misprediction rate when possible.
+ *
+ * Input:		label		name of the line (e.g. thread)
+ *			pc		counters to show
+ * Return value:	none
+ *
+ */
+void perf_counters_print (const char *label, const struct perf_counters *pc)
+{
+  int e;
+
+  if (perf_counters_available (pc) == 0)
+  {
+    printf ("%-8s hardware counters unavailable (%s)\n", label,
+	    strerror (pc->error ? pc->error : ENOSYS));
+    return;
+  }
+
+  printf ("%-8s", label);
+  for (e = 0; e < PC_NUM_EVENTS; e++)
+  {
+    if (pc->available[e])
+    {
+      printf (" %s %llu", pc_names[e], pc->count[e]);
+    }
+    else
+    {
+      printf (" %s n/a", pc_names[e]);
+    }
+  }
+
+  if (pc->available[PC_CYCLES] && pc->available[PC_INSTRUCTIONS] &&
+      pc->count[PC_CYCLES] > 0)
+  {
+    printf ("\n%-8s IPC %.2f", "",
+	    (double) pc->count[PC_INSTRUCTIONS] / pc->count[PC_CYCLES]);
+  }
+  else
+  {
+    printf ("\n%-8s IPC n/a", "");
+  }
+  if (pc->available[PC_BRANCHES] && pc->available[PC_BRANCH_MISSES] &&
+      pc->count[PC_BRANCHES] > 0)
+  {
+    printf (", branch misprediction rate %.2f%%",
+	    100.0 * pc->count[PC_BRANCH_MISSES] / pc->count[PC_BRANCHES]);
+  }
+  else
+  {
+    printf (", branch misprediction rate n/a");
+  }
+  printf ("\n");
+}
+
+
+/* perf_counters_print_stats relates the counters to the backtracking
+ * loop: how many is_safe calls were made, how many positions were
+ * rejected and the branch-misses of the whole solve per is_safe call.
+ * The misses aren't attributed to is_safe, they include the recursion
+ * and the rest of the loop, so it's only a rough ratio.
+ *
+ * Input:		pc		counters of the loop
+ *			checks		calls to is_safe
+ *			conflicts	positions under attack
+ *			placed		positions tried recursively
+ * Return value:	none
+ *
+ */
+void perf_counters_print_stats (const struct perf_counters *pc,
+				unsigned long long checks,
+				unsigned long long conflicts,
+				unsigned long long placed)
+{
+  printf ("%-8s is_safe calls %llu, rejected positions %llu (%.2f%%)",
+	  "", checks, conflicts,
+	  (conflicts + placed) > 0 ?
+	  100.0 * conflicts / (conflicts + placed) : 0.0);
+  if (pc->available[PC_BRANCH_MISSES] && checks > 0)
+  {
+    printf (", %.3f branch-misses per is_safe call (whole solve)",
+	    (double) pc->count[PC_BRANCH_MISSES] / checks);
+  }
+  printf ("\n");
+}
@@ -0,0 +1,50 @@
+/* Per-thread hardware performance counters based on the Linux
+ * perf_event_open system call. Each thread opens its own set of
+ * counters (cycles, instructions, branches, branch-misses, L1 data
+ * cache and last level cache misses), so the values only reflect the
+ * work done by the calling thread.
+ *
+ * Counters that the CPU, the kernel or the perf_event_paranoid setting
+ * don't allow are marked as unavailable and the rest keep working. On
+ * systems without perf_event_open all of them are unavailable.
+ *
+ *
+ * File: perf_counters.h
+ * Date: 18.10.2026
+ */
+
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+enum pc_event				/* hardware events to count	*/
+{
+  PC_CYCLES,
+  PC_INSTRUCTIONS,
+  PC_BRANCHES,
+  PC_BRANCH_MISSES,
+  PC_L1D_MISSES,
+  PC_LLC_MISSES,
+  PC_NUM_EVENTS
+};
+
+struct perf_counters
+{
+  int fd[PC_NUM_EVENTS];		/* file descriptor per event	*/
+  int available[PC_NUM_EVENTS];		/* event could be counted?	*/
+  unsigned long long count[PC_NUM_EVENTS]; /* (scaled) event counts	*/
+  int error;				/* errno of the first failure	*/
+};
+
+
+void perf_counters_clear (struct perf_counters *);
+int perf_counters_start (struct perf_counters *);
+void perf_counters_stop (struct perf_counters *);
+void perf_counters_add (struct perf_counters *, const struct perf_counters *);
+int perf_counters_available (const struct perf_counters *);
+void perf_counters_print (const char *, const struct perf_counters *);
+void perf_counters_print_stats (const struct perf_counters *,
+				unsigned long long, unsigned long long,
+				unsigned long long);
+
+#endif
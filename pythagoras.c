@@ -11,8 +11,13 @@
  * It uses mutex to protect the shared data. To compile it may be 
  * necessary to add the option -lm to link the math.h library.
  * 
+ * Optionally, when compiled with -DTRACE and trace.c, it writes a 
+ * timeline of the threads (start, work, waiting for mutexsum, critical 
+ * section, exit) to trace.json, see trace.h.
+ * 
  * Compilation
  *	gcc -lm -Wall -lpthread -o pythagoras pythagoras.c
+ *	gcc -DTRACE -lm -Wall -lpthread -o pythagoras pythagoras.c trace.c
  * 
  * Execution 
  *	./pythagoras <side_a> <side_b>
@@ -28,6 +33,7 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <math.h>
+#include "trace.h"
 
 #define NUM_THREADS 2			/* default number of threads	*/
 
@@ -88,14 +94,19 @@ int main (int argc, char **argv)
   pthread_mutex_init (&mutexsum, NULL);
   
   /* Create the threads	and calculate the squares on the sides		*/
+  TRACE_THREAD_NAME ("main");
+  TRACE_BEGIN ("create threads");
   pthread_create (&thr_ids[0], NULL, square_side, &sides[0]);
   pthread_create (&thr_ids[1], NULL, square_side, &sides[1]);
+  TRACE_END ("create threads");
   
   /* Using join to syncronize the threads				*/
+  TRACE_BEGIN ("join threads");
   for (i = 0; i < NUM_THREADS; i++)		
   {
     pthread_join (thr_ids[i], NULL);
   }
+  TRACE_END ("join threads");
   
   printf ("Hypotenuse is %.2f\n", sqrt(hypotenuse)); 
   
@@ -122,12 +133,19 @@ void *square_side (void *arg)
 
   /* Get the value of the triangle side	and print the square 		*/
   side = *( ( float* )arg );
+  TRACE_THREAD_NAME ("square_side %.2f", side);
+  TRACE_BEGIN ("square_side");
   printf ("%.2f^2 = %.2f\n", side, side * side); 
   
   /* Mutex lock/unlock to safely update the value of hypotenuse		*/
+  TRACE_BEGIN ("wait mutexsum");
   pthread_mutex_lock (&mutexsum);
+  TRACE_END ("wait mutexsum");
+  TRACE_BEGIN ("critical section");
   hypotenuse += side * side;
   pthread_mutex_unlock (&mutexsum);
+  TRACE_END ("critical section");
   
+  TRACE_END ("square_side");
   pthread_exit (EXIT_SUCCESS);		/* Terminate the thread		*/
 }
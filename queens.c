@@ -11,11 +11,24 @@
  * of queens. Finally, it shows the total number of solutions and 
  * prints to stdout (e.g. the screen) one of them. To compile it may be 
  * necessary to add the option -D_BSD_SOURCE to be able to use the 
- * timing functions.
+ * timing functions. The puzzle is solved by the sequential engine of
+ * the nqueens library (nqueens.c and dlx.c), this program only
+ * handles the command line and the output.
+ * 
+ * Optionally, when compiled with -DPERF_COUNTERS on Linux, it reads 
+ * the hardware performance counters (cycles, instructions, branches, 
+ * branch-misses, L1/LLC misses) around the solve and shows the IPC and 
+ * branch misprediction rate, together with how often the is_safe loop 
+ * rejected a position. If the counters can't be opened it says so and 
+ * carries on. Counting the is_safe calls adds increments to the hot 
+ * loop, so this build perturbs the IPC it measures, and the branch- 
+ * misses per is_safe call are those of the whole solve. 
  * 
  * 
  * Compilation
- *	gcc -D_BSD_SOURCE -o queens queens.c
+ *	gcc -D_BSD_SOURCE -o queens queens.c nqueens.c dlx.c -lpthread
+ *	gcc -D_BSD_SOURCE -DPERF_COUNTERS -o queens queens.c nqueens.c dlx.c \
+ *	    perf_counters.c -lpthread
  * 
  * Execution 
  *	./queens [number_of_queens]
@@ -29,32 +42,43 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <sys/time.h>
+#include "nqueens.h"
+#ifdef PERF_COUNTERS
+#include "perf_counters.h"
+#endif
 
-#define NUM_QUEENS 8			/* default number of queens	*/
-#define ITS_SAFE   0			/* queen on a safe position	*/
-#define NOT_SAFE   1			/* or not			*/
+#define NUM_QUEENS NQ_NUM_QUEENS	/* default number of queens	*/
 
 
 /* Shared global variables.				  	  	*/
-int solutions,		  		/* total number of solutions	*/
-    *queen_on,				/* track positions of the queen */
-    nq;					/* number of queens		*/		
+int nq;					/* number of queens		*/
 char **board;				/* NxN chess board		*/
 char show = 1;				/* flag to save the board	*/
+#ifdef PERF_COUNTERS
+struct perf_counters counters;		/* hardware counters		*/
+#endif
 
 
-void nqueens (int);	  		/* find total solutions		*/
-int is_safe (int, int, int);		/* is queen in a safe position?	*/
+void save_board (const int *, int, int, void *); /* keep a solution	*/
 void pboard (void);			/* show a solution on stdout	*/
+#ifdef PERF_COUNTERS
+void start_counters (int, void *);	/* counters around the solve	*/
+void stop_counters (int, void *);
+void pperf (nq_solver *);		/* show counters on stdout	*/
+#endif
 
 
 int main (int argc, char **argv)
 {
-  int i;				/* loop variable		*/
+  int i,				/* loop variable		*/
+      err;				/* error number			*/
   struct timeval tval_before,		/* timing variables		*/
 	 tval_after, tval_result;
+  struct nq_config config;		/* solver configuration		*/
+  nq_solver *solver;			/* solver handle		*/
 
   switch (argc)				/* check command line arguments	*/
   {
@@ -87,10 +111,9 @@ int main (int argc, char **argv)
   }
 
   /* allocate memory for all dynamic data structures and validate them 	*/
-  queen_on = (int *) malloc(nq * sizeof (int));
   board = (char **) malloc(nq * sizeof (char *));
   
-  if ((queen_on == NULL) || (board == NULL))
+  if (board == NULL)
   {
     fprintf (stderr, "File: %s, line %d: Can't allocate memory.",
 	     __FILE__, __LINE__);
@@ -108,23 +131,42 @@ int main (int argc, char **argv)
     }
   }
 
+  /* Sequential solver that keeps the first solution on the board	*/
+  nq_config_init (&config);
+  config.nq = nq;
+  config.engine = NQ_ENGINE_SEQUENTIAL;
+  config.on_solution = save_board;
+#ifdef PERF_COUNTERS
+  config.on_thread_start = start_counters;
+  config.on_thread_stop = stop_counters;
+#endif
+  err = nq_create (&solver, &config);
+  if (err != 0)
+  {
+    fprintf (stderr, "File: %s, line %d: Can't create the solver: %s.",
+	     __FILE__, __LINE__, strerror (err));
+    exit (EXIT_FAILURE);
+  }
+
   /* Get start time and solve the nqueens			 	*/
-  solutions = 0;
   gettimeofday(&tval_before, NULL);
-  nqueens (0);
+  nq_solve (solver);
   /* calculate and show the elapsed time			  	*/
   gettimeofday(&tval_after, NULL);
   timersub(&tval_after, &tval_before, &tval_result);
   printf("\nElapsed time: %ld.%06ld", (long int)tval_result.tv_sec, 
        (long int)tval_result.tv_usec);
 
-  printf ("\nThere are %d solutions for %d queens. Here's one of them:\n\n",
-	 solutions, nq);
+  printf ("\nThere are %ld solutions for %d queens. Here's one of them:\n\n",
+	 nq_solutions (solver), nq);
 
   pboard ();				/* show one solution		*/
+#ifdef PERF_COUNTERS
+  pperf (solver);			/* show hardware counters	*/
+#endif
   
   /* Deallocate any memory or resources associated			*/
-  free (queen_on);
+  nq_destroy (solver);
   for (i = 0; i < nq; i++) 
   {
     free (board[i]);
@@ -135,67 +177,32 @@ int main (int argc, char **argv)
 }
 
 
-/* nqueens calculates the total number of solutions using recursion 
- * and backtracing.
+/* save_board is called by the solver for every solution and keeps the
+ * first one on the board.
  *
- * Input:		col		column of the board
+ * Input:		queen_on	row of the queen on every column
+ *			nq		number of queens
+ *			thr_index	number of the solving thread
+ *			arg		not used
  * Return value:	none
  *
  */
-void nqueens (int col)
+void save_board (const int *queen_on, int nq, int thr_index, void *arg)
 {
   int i, j;				/* loop variables		*/
 
-  if (col == nq)			/* tried N queens permutations  */
+  if (show)
   {
-    solutions++;			/* one solution found		*/
-    if (show-- > 0)
+    for (i = 0; i < nq; i++)
     {
-      for (i = 0; i < nq; i++) 
+      for (j = 0; j < nq; j++)
       {
-	for (j = 0; j < nq; j++)
-	{
-	  /* check if the queen is situated on (i,j) position on board */
-	  board[i][j] = (j == queen_on[i] ? 'Q' : ((i + j) & 1) ? '_' : '_');
-	}
+	/* check if the queen is situated on (i,j) position on board */
+	board[i][j] = (j == queen_on[i] ? 'Q' : ((i + j) & 1) ? '_' : '_');
       }
     }
-    return;
-  }
-
-  /* Backtracking - try next column on recursive call */
-  for (i = 0; i < nq; i++)
-  {
-    for (j = 0; j < col && is_safe(i, j, col); j++);
-    if (j < col) {
-      continue;
-    }
-    queen_on[col] = i;
-    nqueens (col + 1);
-  }
-}
-
-
-/* is_safe determines if a queen does not attack other
- *
- * Input:		i, j		board coordinates
- *			col		column of the board
- * Return value:	ITS_SAFE	Queen without problems
- *			NOT_SAFE	Queen under attack!
- *
- */
-int is_safe (int i, int j, int col)
-{
-  if (queen_on[j] == i)
-  {
-    return ITS_SAFE;
-  }
-  if (abs (queen_on[j] - i) == col - j)
-  {
-    return ITS_SAFE;
+    show = 0;				/* only the first one		*/
   }
-
-  return NOT_SAFE;
 }
 
 
@@ -220,3 +227,52 @@ void pboard (void)
     printf ("\n");
   }
 }
+
+
+#ifdef PERF_COUNTERS
+/* start_counters and stop_counters are called by the solving thread
+ * right before and after the solve.
+ *
+ * Input:		thr_index	number of the solving thread
+ *			arg		not used
+ * Return value:	none
+ *
+ */
+void start_counters (int thr_index, void *arg)
+{
+  perf_counters_start (&counters);
+}
+
+void stop_counters (int thr_index, void *arg)
+{
+  perf_counters_stop (&counters);
+}
+
+
+/* pperf shows the hardware counters of the solve and relates them to
+ * the backtracking loop: how many is_safe calls were made, how many
+ * positions were rejected and the branch-misses of the whole solve
+ * per is_safe call.
+ *
+ * Input:		solver		solver with the statistics
+ * Return value:	none
+ *
+ */
+void pperf (nq_solver *solver)
+{
+  struct nq_stats stats;
+  int err;
+
+  err = nq_thread_stats (solver, 0, &stats);
+  printf ("\nHardware performance counters:\n");
+  perf_counters_print ("main", &counters);
+  if (err != 0)
+  {
+    /* Library compiled without -DPERF_COUNTERS			*/
+    printf ("%-8s is_safe calls n/a (%s)\n", "", strerror (err));
+    return;
+  }
+  perf_counters_print_stats (&counters, stats.checks, stats.conflicts,
+			     stats.placed);
+}
+#endif
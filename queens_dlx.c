@@ -0,0 +1,243 @@
+/* The N-Queens Puzzle has many variants that the backtracking of
+ * queens and queens_pth can't express: on a toroidal board the
+ * diagonals wrap around the edges, superqueens also move as knights,
+ * and some squares of the board can be blocked.
+ *
+ * This program solves them with the DLX engine of the nqueens library
+ * (nqueens.c and dlx.c): the puzzle is turned into an exact cover
+ * problem and solved with Knuth's Algorithm X and Dancing Links. The
+ * search is split into subtrees at the given depth, and the threads
+ * take the subtrees from a shared queue. For the plain puzzle it also
+ * runs the backtracking engine of queens_pth with the same number of
+ * threads, checks that both counts match and compares their times.
+ *
+ * Variants
+ *	queens		plain N-Queens (default)
+ *	toroidal	diagonals wrap around the board
+ *	super		queens also move as knights
+ *	toroidal-super	both
+ *
+ * Blocked squares are given as row,col pairs, counting from 0.
+ *
+ * Compilation
+ *	gcc -D_BSD_SOURCE -Wall -lpthread -o queens_dlx queens_dlx.c \
+ *	    nqueens.c dlx.c
+ *
+ * Execution
+ *	./queens_dlx [number_of_queens] [number_of_threads] [variant]
+ *		     [split_depth] [row,col ...]
+ *
+ *
+ * File: queens_dlx.c
+ * Date: 18.10.2026
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "nqueens.h"
+
+#define NUM_QUEENS NQ_NUM_QUEENS	/* default number of queens	*/
+#define NUM_THREAD 8			/* default number of threads	*/
+
+
+double solve (struct nq_config *, long *); /* solve and time it	*/
+void usage (const char *);		/* show usage and exit		*/
+
+
+int main (int argc, char **argv)
+{
+  int i,				/* loop variable		*/
+      nblocked,				/* number of blocked squares	*/
+      *blocked;				/* row, col of blocked squares	*/
+  long dlx_total, bt_total;		/* number of solutions		*/
+  double dlx_time, bt_time;		/* elapsed times		*/
+  const char *variant;			/* name of the variant		*/
+  struct nq_config config;		/* solver configuration		*/
+
+  nq_config_init (&config);
+  config.nthreads = NUM_THREAD;
+  config.engine = NQ_ENGINE_DLX;
+  variant = "queens";
+
+  /* check command line arguments, all of them are optional		*/
+  if (argc > 1)
+  {
+    config.nq = atoi (argv[1]);
+  }
+  if (argc > 2)
+  {
+    config.nthreads = atoi (argv[2]);
+  }
+  if (argc > 3)
+  {
+    variant = argv[3];
+    if (strcmp (variant, "queens") == 0)
+    {
+      config.variant = NQ_VARIANT_QUEENS;
+    }
+    else if (strcmp (variant, "toroidal") == 0)
+    {
+      config.variant = NQ_VARIANT_TOROIDAL;
+    }
+    else if (strcmp (variant, "super") == 0)
+    {
+      config.variant = NQ_VARIANT_SUPER;
+    }
+    else if (strcmp (variant, "toroidal-super") == 0)
+    {
+      config.variant = NQ_VARIANT_TOROIDAL | NQ_VARIANT_SUPER;
+    }
+    else
+    {
+      usage (argv[0]);
+    }
+  }
+  if ((config.nq < 1) || (config.nthreads < 1))
+  {
+    usage (argv[0]);
+  }
+  if (argc > 4)
+  {
+    config.split_depth = atoi (argv[4]);
+    if ((config.split_depth < 0) || (config.split_depth > config.nq))
+    {
+      usage (argv[0]);
+    }
+  }
+  else if (config.split_depth > config.nq)
+  {
+    /* The default is too deep for a small board			*/
+    config.split_depth = config.nq;
+  }
+
+  /* allocate memory for all dynamic data structures and validate them 	*/
+  nblocked = (argc > 5) ? argc - 5 : 0;
+  blocked = (int *) malloc ((2 * nblocked + 1) * sizeof (int));
+  if (blocked == NULL)
+  {
+    fprintf (stderr, "File: %s, line %d: Can't allocate memory.",
+	     __FILE__, __LINE__);
+    exit (EXIT_FAILURE);
+  }
+  for (i = 0; i < nblocked; i++)
+  {
+    if ((sscanf (argv[5 + i], "%d,%d", &blocked[2 * i],
+		 &blocked[2 * i + 1]) != 2) ||
+	(blocked[2 * i] < 0) || (blocked[2 * i] >= config.nq) ||
+	(blocked[2 * i + 1] < 0) || (blocked[2 * i + 1] >= config.nq))
+    {
+      usage (argv[0]);
+    }
+  }
+  config.blocked = blocked;
+  config.nblocked = nblocked;
+
+  printf ("\nDLX engine: %s, %d blocked squares, %d threads, "
+	  "split depth %d",
+	  variant, nblocked, config.nthreads, config.split_depth);
+  dlx_time = solve (&config, &dlx_total);
+  printf ("\nThere are %ld solutions for %d queens.\n", dlx_total, config.nq);
+
+  /* Plain puzzle, compare with the backtracking engine		*/
+  if ((config.variant == NQ_VARIANT_QUEENS) && (nblocked == 0))
+  {
+    config.engine = NQ_ENGINE_PTHREADS;
+    if (config.nthreads > config.nq)
+    {
+      config.nthreads = config.nq;
+    }
+    printf ("\nBacktracking engine: %d threads", config.nthreads);
+    bt_time = solve (&config, &bt_total);
+    printf ("\nThere are %ld solutions for %d queens.\n", bt_total, config.nq);
+
+    if (dlx_total != bt_total)
+    {
+      fprintf (stderr, "Error: the engines found different solutions "
+	       "(%ld and %ld).\n", dlx_total, bt_total);
+      exit (EXIT_FAILURE);
+    }
+    printf ("\nBoth engines agree. DLX took %.2f times the time of "
+	    "backtracking.\n\n", (bt_time > 0) ? dlx_time / bt_time : 0.0);
+  }
+  else
+  {
+    printf ("\n");
+  }
+
+  /* Deallocate any memory or resources associated			*/
+  free (blocked);
+
+  return EXIT_SUCCESS;
+}
+
+
+/* solve creates a solver for the configuration, solves the puzzle and
+ * shows the elapsed time. It doesn't include creating the solver (and
+ * the DLX matrix), but it does include splitting the DLX search.
+ *
+ * Input:		config		solver configuration
+ *			total		where to store the solutions
+ * Return value:	elapsed time in seconds
+ *
+ */
+double solve (struct nq_config *config, long *total)
+{
+  int err;				/* error number			*/
+  nq_solver *solver;			/* solver handle		*/
+  struct timeval tval_before,		/* timing variables		*/
+	 tval_after, tval_result;
+
+  err = nq_create (&solver, config);
+  if (err != 0)
+  {
+    fprintf (stderr, "File: %s, line %d: Can't create the solver: %s.",
+	     __FILE__, __LINE__, strerror (err));
+    exit (EXIT_FAILURE);
+  }
+
+  /* Get start time and solve the nqueens			 	*/
+  gettimeofday(&tval_before, NULL);
+  err = nq_solve (solver);
+  if (err != 0)
+  {
+    fprintf (stderr, "File: %s, line %d: Can't solve: %s.",
+	     __FILE__, __LINE__, strerror (err));
+    exit (EXIT_FAILURE);
+  }
+  /* calculate and show the elapsed time			  	*/
+  gettimeofday(&tval_after, NULL);
+  timersub(&tval_after, &tval_before, &tval_result);
+  printf("\nElapsed time: %ld.%06ld", (long int)tval_result.tv_sec,
+       (long int)tval_result.tv_usec);
+
+  *total = nq_solutions (solver);
+  nq_destroy (solver);
+
+  return tval_result.tv_sec + tval_result.tv_usec / 1e6;
+}
+
+
+/* usage shows how to run the program and terminates it
+ *
+ * Input:		prog		name of the program
+ * Return value:	none
+ *
+ */
+void usage (const char *prog)
+{
+  fprintf (stderr, "Error: wrong parameters.\n"
+	   "Usage:\n"
+	   "  %s [number_of_queens] [number_of_threads] [variant] "
+	   "[split_depth] [row,col ...]\n"
+	   "number_of_queens  should be > 0\n"
+	   "number_of_threads should be > 0\n"
+	   "variant is one of queens, toroidal, super, toroidal-super\n"
+	   "split_depth should be >= 0 and <= number_of_queens\n"
+	   "row,col are blocked squares, both in 0..number_of_queens-1\n",
+	   prog);
+  exit (EXIT_FAILURE);
+}
@@ -10,10 +10,31 @@
  * backtracing. It calculates the time it takes to solve the problem 
  * given N number of queens. Finally, it shows the total number of 
  * solutions. To compile it may be necessary to add the option 
- * -D_BSD_SOURCE to be able to use the timing functions.
+ * -D_BSD_SOURCE to be able to use the timing functions. The puzzle 
+ * is solved by the pthreads engine of the nqueens library (nqueens.c
+ * and dlx.c), this program only handles the command line and the output.
+ * 
+ * Optionally, when compiled with -DPERF_COUNTERS on Linux, every 
+ * thread reads its own hardware performance counters (cycles, 
+ * instructions, branches, branch-misses, L1/LLC misses) around its 
+ * part of the solve. The IPC and branch misprediction rate are shown 
+ * per thread and in aggregate, together with how often the is_safe 
+ * loop rejected a position. If the counters can't be opened it says 
+ * so and carries on. Counting the is_safe calls adds increments to the 
+ * hot loop, so this build perturbs the IPC it measures, and the 
+ * branch-misses per is_safe call are those of the whole solve. 
+ * 
+ * Optionally, when compiled with -DTRACE and trace.c, it writes a 
+ * timeline of the threads (start, solve, exit) to trace.json, see 
+ * trace.h.
  * 
  * Compilation
- *	gcc -D_BSD_SOURCE -Wall -lpthread -o queens_pth queens_pth.c
+ *	gcc -D_BSD_SOURCE -Wall -lpthread -o queens_pth queens_pth.c \
+ *	    nqueens.c dlx.c
+ *	gcc -D_BSD_SOURCE -DPERF_COUNTERS -Wall -lpthread -o queens_pth \
+ *	    queens_pth.c nqueens.c dlx.c perf_counters.c
+ *	gcc -D_BSD_SOURCE -DTRACE -Wall -lpthread -o queens_pth \
+ *	    queens_pth.c nqueens.c dlx.c trace.c
  * 
  * Execution 
  *	./queens_pth [number_of_queens] [number_of_threads]
@@ -26,36 +47,40 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#include <pthread.h>
 #include <sys/time.h>
+#include "nqueens.h"
+#ifdef PERF_COUNTERS
+#include "perf_counters.h"
+#endif
 
-#define NUM_QUEENS 8			/* default number of queens	*/
+#define NUM_QUEENS NQ_NUM_QUEENS	/* default number of queens	*/
 #define NUM_THREAD 8			/* default number of threads	*/
-#define ITS_SAFE   0			/* queen on a safe position	*/
-#define NOT_SAFE   1			/* or not			*/
 
 
 /* Shared global variables.				  	  	*/
-int *solutions,				/* number of solutions by thd	*/
-    **queen_on,				/* track positions of the queen */
-    nq,					/* number of queens		*/
+int nq,					/* number of queens		*/
     nthreads;				/* number of threads		*/
-    
+#ifdef PERF_COUNTERS
+struct perf_counters *counters;		/* hardware counters by thd	*/
+#endif
+
 
-void *start_thread (void *);    
-void nqueens (int, int);		/* find total solutions		*/
-int is_safe (int, int, int, int);	/* is queen in a safe position?	*/  
+#ifdef PERF_COUNTERS
+void start_counters (int, void *);	/* counters around each thread	*/
+void stop_counters (int, void *);
+void pperf (nq_solver *);		/* show counters on stdout	*/
+#endif
 
 
 int main (int argc, char **argv)
 {
-  pthread_t *thr_ids;			/* array of thread ids		*/
-  int i, j,				/* loop variables		*/
-      *thr_num,				/* array of thread numbers	*/
-      total;				/* total number of solutions	*/
+  int err;				/* error number			*/
   struct timeval tval_before,		/* timing variables		*/
 	 tval_after, tval_result;
+  struct nq_config config;		/* solver configuration		*/
+  nq_solver *solver;			/* solver handle		*/
 
   switch (argc)				/* check command line arguments	*/
   {
@@ -111,51 +136,45 @@ int main (int argc, char **argv)
       exit (EXIT_FAILURE);
   }
   
+#ifdef PERF_COUNTERS
   /* allocate memory for all dynamic data structures and validate them 	*/
-  thr_num   = (int *) malloc (nthreads * sizeof (int));
-  thr_ids   = (pthread_t *) malloc (nthreads * sizeof (pthread_t));
-  queen_on  = (int **) malloc (nq * sizeof (int *));
-  solutions = (int *) malloc (nq * sizeof (int));
-  
-  if ((thr_num == NULL) || (thr_ids == NULL) ||
-      (queen_on == NULL) || (solutions == NULL)) 
+  counters = (struct perf_counters *)
+	     calloc (nthreads, sizeof (struct perf_counters));
+  if (counters == NULL)
   {
     fprintf (stderr, "File: %s, line %d: Can't allocate memory.",
 	     __FILE__, __LINE__);
     exit (EXIT_FAILURE);
   }
-  
-  for (i = 0; i < nq; i++)
+#endif
+
+  /* Rows of the first column are split among the threads		*/
+  nq_config_init (&config);
+  config.nq = nq;
+  config.nthreads = nthreads;
+  config.engine = NQ_ENGINE_PTHREADS;
+#ifdef PERF_COUNTERS
+  config.on_thread_start = start_counters;
+  config.on_thread_stop = stop_counters;
+#endif
+  err = nq_create (&solver, &config);
+  if (err != 0)
   {
-    queen_on[i] = (int *) malloc(nq * sizeof (int));
-    if (queen_on[i] == NULL)
-    {
-      fprintf (stderr, "File: %s, line %d: Can't allocate memory.",
-	       __FILE__, __LINE__);
-      exit (EXIT_FAILURE);
-    }
-    for (j = 0; j < nq; j++)
-    {
-      queen_on[i][j] = 0;
-    }
+    fprintf (stderr, "File: %s, line %d: Can't create the solver: %s.",
+	     __FILE__, __LINE__, strerror (err));
+    exit (EXIT_FAILURE);
   }
 
   /* Get start time and solve the nqueens			 	*/
   gettimeofday(&tval_before, NULL);
   
-  /* Create the threads	and let them do their work		  	*/
-  for (i = 0; i < nthreads; i++) 
-  {
-    thr_num[i] = i;			/* Thread number	        */
-    pthread_create (&thr_ids[i], NULL, start_thread, &thr_num[i]); 
-  }
-  
-  /* Sum all solutions by thread to get the total		  	*/
-  total = 0;
-  for (i = 0; i < nthreads; i++) 
+  /* Create the threads, let them do their work and wait for them	*/
+  err = nq_solve (solver);
+  if (err != 0)
   {
-    pthread_join (thr_ids[i], NULL);
-    total += solutions[i];
+    fprintf (stderr, "File: %s, line %d: Can't solve: %s.",
+	     __FILE__, __LINE__, strerror (err));
+    exit (EXIT_FAILURE);
   }
   
   /* calculate and show the elapsed time			  	*/
@@ -163,100 +182,91 @@ int main (int argc, char **argv)
   timersub(&tval_after, &tval_before, &tval_result);
   printf("\nElapsed time: %ld.%06ld", (long int)tval_result.tv_sec, 
        (long int)tval_result.tv_usec);
-  printf ("\nThere are %d solutions for %d queens.\n\n", total, nq);
+  printf ("\nThere are %ld solutions for %d queens.\n\n",
+	  nq_solutions (solver), nq);
+#ifdef PERF_COUNTERS
+  pperf (solver);			/* show hardware counters	*/
+#endif
 
   /* Deallocate any memory or resources associated			*/
-  for (i = 0; i < nq; i++)
-  {
-    free (queen_on[i]);
-  }
-  free (queen_on); 
-  free (solutions);
-  free (thr_num);
-  free (thr_ids);
+  nq_destroy (solver);
+#ifdef PERF_COUNTERS
+  free (counters);
+#endif
 
   return EXIT_SUCCESS;
 }
 
 
-/* start_thread runs as a peer thread and will execute the nqueens
- * function concurrently to find the number of possible solutions
+#ifdef PERF_COUNTERS
+/* start_counters and stop_counters are called by every solving thread
+ * right before and after its part of the solve, so the counters only
+ * see the work of that thread.
  *
- * Input:		arg		pointer to current thread number
+ * Input:		thr_index	number of current thread
+ *			arg		not used
  * Return value:	none
  *
  */
-void *start_thread (void *arg)
+void start_counters (int thr_index, void *arg)
 {
-  int thr_index;
-    
-  /* Get the index number of current thread				*/
-  thr_index = *( ( int* )arg );
-  /* Set start number of solutions for current thread			*/
-  solutions[thr_index] = 0;
-  /* Release the Kraken!						*/
-  nqueens (0, thr_index);
+  perf_counters_start (&counters[thr_index]);
+}
 
-  pthread_exit (EXIT_SUCCESS);		/* Terminate the thread		*/
+void stop_counters (int thr_index, void *arg)
+{
+  perf_counters_stop (&counters[thr_index]);
 }
 
 
-/* nqueens calculates the total number of solutions using recursion 
- * and backtracing.
+/* pperf shows the hardware counters of every thread and their sum,
+ * and relates them to the backtracking loop: how many is_safe calls 
+ * were made, how many positions were rejected and the branch-misses 
+ * of the whole solve per is_safe call.
  *
- * Input:		col		column of the board
- *			thr_index	number of current thread
+ * Input:		solver		solver with the statistics
  * Return value:	none
  *
  */
-void nqueens (int col, int thr_index)
+void pperf (nq_solver *solver)
 {
-  int i, j,				/* loop variables		*/  
-      start, end;			/* position variables		*/
-  
-  /* start/end point to cover all rows					*/
-  start = (col > 0) ? 0 : thr_index * (nq / nthreads);
-  end	= ((col > 0) || (thr_index == nthreads -1)) ? 
-	  nq - 1 : (thr_index + 1) * (nq / nthreads) - 1;
+  int i, err = 0;
+  char label[16];
+  struct perf_counters total, *pc;
+  struct nq_stats stats, total_stats;
 
-  if (col == nq)			/* tried N queens permutations  */
-  {      
-    solutions[thr_index]++;		/* peer found one solution 	*/
-  }
+  printf ("Hardware performance counters:\n");
+  perf_counters_clear (&total);
+  total_stats.checks = total_stats.conflicts = total_stats.placed = 0;
 
-  /* Backtracking - try next column on recursive call for current thd	*/
-  for (i = start; i <= end; i++) 
+  for (i = 0; i <= nthreads; i++)
   {
-    for (j = 0; j < col && is_safe(i, j, col, thr_index); j++);
-    if (j < col) 
+    if (i < nthreads)
     {
-      continue;
+      snprintf (label, sizeof (label), "thd %d", i);
+      pc = &counters[i];
+      err = nq_thread_stats (solver, i, &stats);
+      perf_counters_add (&total, pc);
+      total_stats.checks    += stats.checks;
+      total_stats.conflicts += stats.conflicts;
+      total_stats.placed    += stats.placed;
+    }
+    else
+    {
+      snprintf (label, sizeof (label), "total");
+      pc = &total;
+      stats = total_stats;
     }
-    queen_on[thr_index][col] = i;
-    nqueens (col + 1, thr_index);
-  }
-}
-
 
-/* is_safe determines if a queen does not attack other
- *
- * Input:		i, j		board coordinates
- *			col		column of the board
- *			thr_index	number of current thread
- * Return value:	ITS_SAFE	Queen without problems
- *			NOT_SAFE	Queen under attack!
- *
- */
-int is_safe (int i, int j, int col, int thr_index)
-{
-  if (queen_on[thr_index][j] == i)
-  {
-    return ITS_SAFE;
-  }
-  if (abs(queen_on[thr_index][j] - i) == col - j)
-  {
-    return ITS_SAFE;
+    perf_counters_print (label, pc);
+    if (err != 0)
+    {
+      /* Library compiled without -DPERF_COUNTERS			*/
+      printf ("%-8s is_safe calls n/a (%s)\n", "", strerror (err));
+      continue;
+    }
+    perf_counters_print_stats (pc, stats.checks, stats.conflicts,
+			       stats.placed);
   }
-
-  return NOT_SAFE;
 }
+#endif
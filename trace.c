@@ -0,0 +1,310 @@
+/* Opt-in timeline tracing for the threaded programs. See trace.h for
+ * the interface.
+ *
+ * Every thread gets its own buffer the first time it records an
+ * event. The buffer is pushed with a compare-and-swap to a global
+ * list, which is only read at exit, so recording an event never takes
+ * a lock: it reads the clock and appends to the buffer of the thread.
+ * The events are kept in a list of fixed-size chunks, and a full chunk
+ * is never reallocated or copied; a new one is added instead, once
+ * every TRACE_EVENTS events. That malloc is the only one made while
+ * recording, and it shows up in the timeline as "trace alloc" so it
+ * can't be mistaken for the work being traced. Buffers are never
+ * freed, because the threads are gone when they are written.
+ *
+ *
+ * File: trace.c
+ * Date: 18.10.2026
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "trace.h"
+
+#define TRACE_EVENTS  4096		/* events of a chunk		*/
+#define TRACE_NAME    32		/* length of a thread name	*/
+#define TRACE_DEFAULT "trace.json"	/* default trace file		*/
+
+struct trace_event			/* one recorded event		*/
+{
+  const char *name;			/* string literal		*/
+  char phase;				/* B(egin), E(nd) or i(nstant)	*/
+  long long ts;				/* nanoseconds since start	*/
+};
+
+struct trace_chunk			/* fixed-size block of events	*/
+{
+  struct trace_chunk *next;		/* next chunk of the thread	*/
+  int nevents;				/* used events			*/
+  struct trace_event events[TRACE_EVENTS];
+};
+
+struct trace_buffer			/* events of one thread		*/
+{
+  struct trace_buffer *next;		/* list of all the buffers	*/
+  int tid;				/* thread number in the trace	*/
+  long dropped;				/* events without memory	*/
+  char name[TRACE_NAME];		/* thread name, if given	*/
+  struct trace_chunk *first, *last;	/* chunks of events		*/
+};
+
+
+static _Thread_local struct trace_buffer *local; /* of this thread	*/
+static _Atomic (struct trace_buffer *) buffers;	/* of all threads	*/
+static atomic_int next_tid;		/* next thread number		*/
+static struct timespec start;		/* time of the first event	*/
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+
+static void trace_init (void);
+static struct trace_buffer *trace_buffer (void);
+static struct trace_chunk *trace_chunk (struct trace_buffer *);
+static void trace_append (struct trace_chunk *, const char *, char,
+			  long long);
+static void trace_dump (void);
+static long long trace_now (void);
+
+
+/* trace_event records an event of the calling thread
+ *
+ * Input:		name		name of the event (literal)
+ *			phase		'B' begin, 'E' end, 'i' instant
+ * Return value:	none
+ *
+ */
+void trace_event (const char *name, char phase)
+{
+  struct trace_buffer *b;
+  struct trace_chunk *c;
+
+  b = (local != NULL) ? local : trace_buffer ();
+  if (b == NULL)
+  {
+    return;
+  }
+
+  /* Only this thread touches its buffer, no lock needed		*/
+  c = b->last;
+  if (c->nevents == TRACE_EVENTS)
+  {
+    c = trace_chunk (b);
+    if (c == NULL)
+    {
+      b->dropped++;
+      return;
+    }
+  }
+  trace_append (c, name, phase, trace_now ());
+}
+
+
+/* trace_thread_name gives a name to the calling thread in the trace
+ *
+ * Input:		fmt, ...	printf-like name
+ * Return value:	none
+ *
+ */
+void trace_thread_name (const char *fmt, ...)
+{
+  struct trace_buffer *b;
+  va_list ap;
+
+  b = (local != NULL) ? local : trace_buffer ();
+  if (b == NULL)
+  {
+    return;
+  }
+  va_start (ap, fmt);
+  vsnprintf (b->name, sizeof (b->name), fmt, ap);
+  va_end (ap);
+}
+
+
+/* trace_init takes the start time of the trace and writes the trace
+ * at exit. It runs only once, before the first buffer is created.
+ *
+ * Input:		none
+ * Return value:	none
+ *
+ */
+static void trace_init (void)
+{
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  atexit (trace_dump);
+}
+
+
+/* trace_buffer creates the buffer of the calling thread and adds it
+ * to the list of all the buffers.
+ *
+ * Input:		none
+ * Return value:	buffer of the thread, or NULL if there's no memory
+ *
+ */
+static struct trace_buffer *trace_buffer (void)
+{
+  struct trace_buffer *b;
+
+  pthread_once (&once, trace_init);
+
+  b = (struct trace_buffer *) calloc (1, sizeof (struct trace_buffer));
+  if (b == NULL)
+  {
+    return NULL;
+  }
+  b->first = b->last = (struct trace_chunk *)
+		       malloc (sizeof (struct trace_chunk));
+  if (b->first == NULL)
+  {
+    free (b);
+    return NULL;
+  }
+  b->first->next = NULL;
+  b->first->nevents = 0;
+  b->tid = atomic_fetch_add (&next_tid, 1) + 1;
+  snprintf (b->name, sizeof (b->name), "thread %d", b->tid);
+
+  /* Lock-free push to the list of buffers				*/
+  b->next = atomic_load (&buffers);
+  while (!atomic_compare_exchange_weak (&buffers, &b->next, b));
+
+  local = b;
+  return b;
+}
+
+
+/* trace_chunk adds a new chunk to the buffer of the calling thread,
+ * when the last one is full. The time it takes is recorded as a
+ * "trace alloc" event in the new chunk.
+ *
+ * Input:		b		buffer of the thread
+ * Return value:	new chunk, or NULL if there's no memory
+ *
+ */
+static struct trace_chunk *trace_chunk (struct trace_buffer *b)
+{
+  struct trace_chunk *c;
+  long long ts;
+
+  ts = trace_now ();
+  c = (struct trace_chunk *) malloc (sizeof (struct trace_chunk));
+  if (c == NULL)
+  {
+    return NULL;
+  }
+  c->next = NULL;
+  c->nevents = 0;
+  b->last->next = c;
+  b->last = c;
+
+  trace_append (c, "trace alloc", 'B', ts);
+  trace_append (c, "trace alloc", 'E', trace_now ());
+  return c;
+}
+
+
+/* trace_append appends an event to a chunk that isn't full
+ *
+ * Input:		c		chunk of the thread
+ *			name		name of the event (literal)
+ *			phase		'B' begin, 'E' end, 'i' instant
+ *			ts		nanoseconds since start
+ * Return value:	none
+ *
+ */
+static void trace_append (struct trace_chunk *c, const char *name,
+			  char phase, long long ts)
+{
+  struct trace_event *e = &c->events[c->nevents++];
+
+  e->name = name;
+  e->phase = phase;
+  e->ts = ts;
+}
+
+
+/* trace_dump writes all the buffers to the trace file in the Chrome
+ * trace event format (JSON), with a name for every thread. It runs at
+ * exit.
+ *
+ * Input:		none
+ * Return value:	none
+ *
+ */
+static void trace_dump (void)
+{
+  struct trace_buffer *b;
+  struct trace_chunk *c;
+  const char *path, *sep = "";
+  FILE *f;
+  int i, pid;
+  long dropped = 0;
+
+  path = getenv ("TRACE_FILE");
+  if ((path == NULL) || (*path == '\0'))
+  {
+    path = TRACE_DEFAULT;
+  }
+  f = fopen (path, "w");
+  if (f == NULL)
+  {
+    fprintf (stderr, "Error: can't write the trace to %s.\n", path);
+    return;
+  }
+
+  pid = (int) getpid ();
+  fprintf (f, "{\"traceEvents\":[\n");
+  for (b = atomic_load (&buffers); b != NULL; b = b->next)
+  {
+    fprintf (f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+	     "\"tid\":%d,\"args\":{\"name\":\"%s\"}}", sep, pid, b->tid,
+	     b->name);
+    sep = ",\n";
+    for (c = b->first; c != NULL; c = c->next)
+    {
+      for (i = 0; i < c->nevents; i++)
+      {
+	/* Timestamps are in microseconds				*/
+	fprintf (f, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld.%03lld,"
+		 "\"pid\":%d,\"tid\":%d%s}", c->events[i].name,
+		 c->events[i].phase, c->events[i].ts / 1000,
+		 c->events[i].ts % 1000, pid, b->tid,
+		 (c->events[i].phase == 'i') ? ",\"s\":\"t\"" : "");
+      }
+    }
+    dropped += b->dropped;
+  }
+  fprintf (f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  fclose (f);
+
+  fprintf (stderr, "Trace written to %s", path);
+  if (dropped > 0)
+  {
+    fprintf (stderr, " (%ld events dropped)", dropped);
+  }
+  fprintf (stderr, "\n");
+}
+
+
+/* trace_now reads the monotonic clock
+ *
+ * Input:		none
+ * Return value:	nanoseconds since the start of the trace
+ *
+ */
+static long long trace_now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec - start.tv_sec) * 1000000000LL +
+	 (ts.tv_nsec - start.tv_nsec);
+}
@@ -0,0 +1,43 @@
+/* Opt-in timeline tracing for the threaded programs. When compiled
+ * with -DTRACE (and linked with trace.c), every thread records begin
+ * and end events with monotonic timestamps into its own buffer, with
+ * no locks, and the whole timeline is written at exit in the Chrome
+ * trace event format. The file can be opened with chrome://tracing or
+ * https://ui.perfetto.dev to see when every thread starts, works,
+ * waits and exits.
+ *
+ * The file is trace.json, or the one given in the TRACE_FILE
+ * environment variable. Without -DTRACE the macros do nothing.
+ *
+ * The event names are not copied, they must be string literals. The
+ * threads must have finished when the program exits.
+ *
+ *
+ * File: trace.h
+ * Date: 18.10.2026
+ */
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef TRACE
+
+#define TRACE_BEGIN(name)	trace_event ((name), 'B')
+#define TRACE_END(name)		trace_event ((name), 'E')
+#define TRACE_INSTANT(name)	trace_event ((name), 'i')
+#define TRACE_THREAD_NAME(...)	trace_thread_name (__VA_ARGS__)
+
+void trace_event (const char *, char);
+void trace_thread_name (const char *, ...);
+
+#else
+
+#define TRACE_BEGIN(name)	((void) 0)
+#define TRACE_END(name)		((void) 0)
+#define TRACE_INSTANT(name)	((void) 0)
+#define TRACE_THREAD_NAME(...)	((void) 0)
+
+#endif
+
+#endif